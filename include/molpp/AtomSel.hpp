@@ -8,6 +8,7 @@
 namespace mol {
 
 class Bond;
+class TrajectoryWriter;
 
 class AtomSel : public internal::Sel<Atom, AtomSel>
 {
@@ -26,6 +27,8 @@ protected:
 
     template <class, class>
     friend class internal::Sel;
+    // Maps the selected atoms to the columns of timesteps
+    friend class TrajectoryWriter;
 };
 
 } // namespace mol
@@ -22,6 +22,11 @@ public:
 
     ElementsTable(std::initializer_list<Element> data);
 
+    size_t size() const
+    {
+        return m_atomic.size();
+    }
+
     int const &atomic_number(int const atomic) const
     {
         return m_atomic[atomic];
@@ -4,6 +4,9 @@
 #include <molpp/AtomSel.hpp>
 #include <molpp/MolppCore.hpp>
 #include <molpp/AtomSelector.hpp>
+#include <molpp/Timestep.hpp>
+#include <molpp/Trajectory.hpp>
+#include <molpp/ReaderStats.hpp>
 #include <string>
 #include <memory>
 #include <vector>
@@ -12,6 +15,7 @@ namespace mol {
 
 namespace internal {
 class MolData;
+class MolReader;
 }
 
 class MolSystem
@@ -21,15 +25,70 @@ public:
     MolSystem(MolSystem&& other);
     ~MolSystem();
     void add_trajectory(std::string const& file_name, int begin=0, int end=-1, int step=1);
+    // Only the coordinates of the given atoms are kept. Every frame of
+    // the trajectory then holds these atoms, until it is reset, and
+    // selections of other atoms have no coordinates.
+    void add_trajectory(std::string const& file_name, AtomSel const& atoms, int begin=0, int end=-1, int step=1);
+    void add_lazy_trajectory(std::string const& file_name, int begin=0, int end=-1, int step=1);
+    // Frames from the begin to the end time, in picoseconds, one per
+    // time step or all of them for a zero step. Files telling frame
+    // times without decoding them (XTC, TRR, DCD) are only read where
+    // the frames are.
+    void add_trajectory_times(std::string const& file_name, double begin, double end, double step=0);
+    // Segments are appended as a single lazy trajectory. Each frame is
+    // decoded from the file holding it when accessed.
+    void add_lazy_trajectories(std::vector<std::string> const& file_names, int begin=0, int end=-1, int step=1);
+    // Trajectory segments are decoded concurrently and appended in the
+    // given order. Zero threads means one per hardware thread.
+    void add_trajectories(std::vector<std::string> const& file_names, int begin=0, int end=-1, int step=1, size_t num_threads=0);
+    // Single pass over a trajectory file. Frames are passed to the
+    // callback in a reused timestep and are never stored. A non-zero
+    // prefetch decodes up to that many frames ahead in the background.
+    void stream_trajectory(std::string const& file_name, TimestepCallback const& callback, int begin=0, int end=-1, int step=1, size_t prefetch=0);
+    // A few frame buffers are kept for reuse by the next trajectories,
+    // unless told otherwise
+    void reset_trajectory(bool const keep_buffers = true);
+    // Frames added afterwards are kept in memory quantized to the
+    // given precision, in angstroms, and decoded on access. Zero
+    // disables compression.
+    void set_trajectory_compression(float const precision);
+    // Frames added afterwards are kept in memory as 16-bit
+    // QuantizedTimesteps, with a MolError for frames whose precision
+    // exceeds QuantizedTimestep::TOLERANCE. Compression prevails.
+    void set_trajectory_quantization(bool const enable);
+    // Frames added afterwards are stored contiguously in blocks of the
+    // given number of frames, each allocated at once. Zero allocates
+    // every frame on its own.
+    void set_trajectory_chunk(size_t const num_frames);
+    // Frames of lazy trajectories stay decoded up to the given number
+    // of bytes, least recently used first out. Zero keeps all of them.
+    void set_trajectory_cache(size_t const bytes);
+    FrameCacheStats trajectory_cache_stats() const;
+    // Frames marked as done are the first evicted from the cache
+    void mark_frame_done(size_t const frame);
+    // Counters of the readers of the last trajectory files added or
+    // streamed. Those of lazy trajectories go on as frames are read.
+    ReaderStats reader_stats() const;
+    // Physical time of a frame, in picoseconds
+    double frame_time(size_t const frame) const;
+    // First frame at or after the given time, if any
+    Frame frame_at(double const time) const;
     AtomSel atoms(Frame const frame = std::nullopt) const;
     AtomSel select(std::vector<index_t> const &indices, Frame const frame = std::nullopt) const;
     AtomSel select(std::string const &selection, Frame const frame = std::nullopt) const;
     AtomSelector selector(std::string const& selection) const;
+    // Binary snapshot (.molpp) of atoms, residues and bonds, and
+    // optionally of all frames. Snapshots are loaded as topologies and
+    // their frames are added as any other trajectory file.
+    void save(std::string const& file_name, bool const with_trajectory=false) const;
     void reset_bonds();
+    // Bonds from distances are only guessed between atoms with
+    // coordinates
     void guess_bonds(Frame const frame);
 
 private:
     std::unique_ptr<internal::MolData> m_data;
+    std::vector<std::shared_ptr<internal::MolReader>> m_readers;
 };
 
 } // namespace mol
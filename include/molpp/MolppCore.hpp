@@ -14,6 +14,12 @@ using position_t = float;
 using Point3 = Eigen::Vector<position_t, 3>;
 using Coord3 = Eigen::Matrix<position_t, 3, Eigen::Dynamic>;
 using Coord2 = Eigen::Matrix<position_t, 2, Eigen::Dynamic>;
+using Coord3Map = Eigen::Map<Coord3>;
+using ConstCoord3Map = Eigen::Map<Coord3 const>;
+// Coordinates of atoms over all frames, one atom per column
+// (x, y and z of the first frame, then of the second, etc...)
+using TimeSeries = Eigen::Matrix<position_t, Eigen::Dynamic, Eigen::Dynamic>;
+using ConstTimeSeriesMap = Eigen::Map<TimeSeries const>;
 
 using Frame = std::optional<size_t>;
 
@@ -0,0 +1,53 @@
+#ifndef QUANTIZEDTIMESTEP_HPP
+#define QUANTIZEDTIMESTEP_HPP
+
+#include <molpp/MolppCore.hpp>
+#include <molpp/UnitCell.hpp>
+#include <molpp/Timestep.hpp>
+#include <cstdint>
+
+namespace mol
+{
+
+using QCoord3 = Eigen::Matrix<int16_t, 3, Eigen::Dynamic>;
+
+// Frame with coordinates stored as 16-bit integers relative to the
+// center of its bounding box, at half the size of a Timestep. The
+// scale is chosen per frame so that the largest coordinate fits, so
+// frames wider than about 1310 angstroms exceed the tolerance.
+class QuantizedTimestep
+{
+public:
+    // Largest rounding error accepted by trajectories, in angstroms
+    static constexpr float TOLERANCE = 0.01;
+
+    QuantizedTimestep();
+    QuantizedTimestep(Timestep const& timestep);
+
+    size_t size() const { return m_data.cols(); }
+    Point3 const& origin() const { return m_origin; }
+    float scale() const { return m_scale; }
+    // Largest rounding error, in angstroms
+    float precision() const { return m_scale / 2; }
+    bool within_tolerance() const { return precision() <= TOLERANCE; }
+    QCoord3 const& data() const { return m_data; }
+    // Widened lazily, so that kernels such as SpatialSearch read the
+    // 16-bit values. The expression references this timestep.
+    auto coords() const
+    {
+        return (m_data.cast<position_t>() * m_scale).colwise() + m_origin;
+    }
+    UnitCell const& cell() const { return m_cell; }
+    UnitCell &cell() { return m_cell; }
+    Timestep decode() const;
+
+private:
+    QCoord3 m_data;
+    Point3 m_origin;
+    float m_scale;
+    UnitCell m_cell;
+};
+
+} // namespace mol
+
+#endif // QUANTIZEDTIMESTEP_HPP
@@ -0,0 +1,33 @@
+#ifndef READERSTATS_HPP
+#define READERSTATS_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace mol {
+
+// Counters of trajectory readers. Times are wall times in seconds.
+struct ReaderStats
+{
+    // Bytes read from files, frame headers included
+    size_t bytes_read = 0;
+    size_t frames_decoded = 0;
+    // Frames passed over without decoding them
+    size_t frames_skipped = 0;
+    // Time spent reading files, decoding (decompressing, converting)
+    // frames and copying coordinates into timesteps
+    double io_time = 0;
+    double decode_time = 0;
+    double copy_time = 0;
+    // Most memory held at once by frame buffers of the reader
+    size_t peak_buffer_bytes = 0;
+
+    // Peaks add up, as readers may have run at the same time
+    ReaderStats& operator+=(ReaderStats const& other);
+    // Single JSON object with the fields above
+    std::string json() const;
+};
+
+} // namespace mol
+
+#endif // READERSTATS_HPP
@@ -2,6 +2,9 @@
 #define TIMESTEP_HPP
 
 #include <molpp/MolppCore.hpp>
+#include <molpp/UnitCell.hpp>
+#include <memory>
+#include <functional>
 
 namespace mol
 {
@@ -11,20 +14,43 @@ class Timestep
 public:
     Timestep();
     Timestep(size_t const num_atoms);
+    // View of coordinates stored elsewhere (e.g. memory-mapped
+    // files). The owner keeps the storage alive.
+    Timestep(position_t *coords, size_t const num_atoms, std::shared_ptr<void const> owner);
     Timestep(const Timestep &src) = delete;
     Timestep &operator=(const Timestep &rhs) = delete;
     Timestep(Timestep &&src) noexcept;
     Timestep &operator=(Timestep &&rhs);
     void swap(Timestep &rhs);
 
-    Coord3 &coords() { return m_coords; }
-    Coord3 const& coords() const { return m_coords; }
+    // Owned coordinates and views are both accessed through a map,
+    // which cannot be resized
+    Coord3Map &coords() { return m_map; }
+    ConstCoord3Map coords() const { return ConstCoord3Map(m_data, 3, m_num_atoms); }
+    bool is_view() const { return m_owner != nullptr; }
+    UnitCell &cell() { return m_cell; }
+    UnitCell const& cell() const { return m_cell; }
+    // Physical time, in picoseconds. Zero when unknown.
+    double &time() { return m_time; }
+    double time() const { return m_time; }
 
 private:
+    // Points the map at the current data
+    void bind();
+
     size_t m_num_atoms;
     Coord3 m_coords;
+    position_t *m_data;
+    Coord3Map m_map;
+    std::shared_ptr<void const> m_owner;
+    UnitCell m_cell;
+    double m_time;
 };
 
+// Receives streamed frames and their index in the file. Returning
+// false stops the stream.
+using TimestepCallback = std::function<bool(size_t const frame, Timestep &timestep)>;
+
 } // namespace mol
 
 #endif // TIMESTEP_HPP
@@ -2,35 +2,178 @@
 #define TRAJECTORY_HPP
 
 #include <molpp/Timestep.hpp>
+#include <molpp/MolppCore.hpp>
+#include <memory>
 #include <vector>
+#include <list>
+#include <optional>
+#include <mutex>
 
 namespace mol {
 
+namespace internal {
+class FrameSource;
+class TimestepPool;
+class CompressedFrames;
+class QuantizedFrames;
+class FrameChunks;
+}
+
+struct FrameCacheStats
+{
+    // Accesses to lazy frames already decoded or not
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    // Coordinates held by the cache
+    size_t bytes = 0;
+};
+
+// Const accesses may be made from several threads: decoding lazy
+// frames and updating the cache and the time series are serialized.
+// References to transient frames (compressed ones, or lazy ones with
+// a cache limit) may still be invalidated by accesses from other
+// threads. Non-const functions must not run concurrently with any
+// other access.
 class Trajectory
 {
 public:
-    Trajectory()
-    {}
+    Trajectory();
 
     size_t num_frames() const {
         return m_timestep.size();
     }
 
-    Timestep &timestep(size_t const index) {
-        return m_timestep[index];
-    }
+    // Transient frames accessed for writing are stored back to their
+    // source when dropped
+    Timestep &timestep(size_t const index);
+    Timestep const& timestep(size_t const index) const;
+    void add_timestep(Timestep &&ts);
+    // Lazy frames are decoded from the source on first access
+    void add_frames(std::shared_ptr<internal::FrameSource> source);
+    // Removes all frames. Some of their buffers, up to the pool
+    // capacity, are kept for reuse by the next frames read, unless
+    // told otherwise.
+    void clear(bool const keep_buffers = true);
+    internal::TimestepPool &pool() const;
+    // Timesteps added afterwards are stored quantized to the given
+    // precision, in angstroms, and decoded on access. Only the last
+    // compressed frame accessed stays decoded, so references to the
+    // others are invalidated. Frames accessed through the non-const
+    // timestep() are compressed again, at the same precision, when
+    // another frame is decoded, unless their coordinates did not
+    // change. Zero disables compression.
+    void set_compression(float const precision);
+    float compression() const;
+    // Timesteps added afterwards are stored as QuantizedTimesteps and
+    // widened on access, with the same transient frames as compressed
+    // trajectories. Throws a MolError when adding a frame whose
+    // precision exceeds QuantizedTimestep::TOLERANCE. Compression
+    // prevails.
+    void set_quantization(bool const enable);
+    bool quantization() const;
+    // Timesteps added afterwards are copied back to back into blocks
+    // of this many frames, allocated at once, and kept as views.
+    // Zero keeps each frame in its own buffer. Compression prevails.
+    void set_chunk_frames(size_t const num_frames);
+    size_t chunk_frames() const;
+    // Frames added afterwards only keep the coordinates of the given
+    // atoms, out of the num_atoms of the system. Indices must be sorted.
+    // Throws a MolError if the trajectory has frames with other atoms.
+    // The subset is dropped by clear().
+    void set_atoms(std::vector<index_t> const& indices, size_t const num_atoms);
+    // Atoms with coordinates. Empty when all of them have.
+    std::vector<index_t> const& atoms() const;
+    // Timestep columns holding the given atoms. Throws a MolError
+    // for atoms without coordinates.
+    std::vector<index_t> columns(std::vector<index_t> const& indices) const;
+    // Copies the coordinates of the trajectory atoms out of a timestep
+    // of the whole system, recycling its buffer. Other timesteps are
+    // returned as they are.
+    Timestep gather(Timestep &&ts) const;
+    // Atom-major copy of all frames, where column i holds the i-th
+    // timestep column. It is built on first call by a parallel blocked
+    // transposition and kept until frames are added or removed, so
+    // later changes to coordinates are not reflected. Zero threads
+    // means one per hardware thread.
+    ConstTimeSeriesMap time_series(size_t const num_threads = 0) const;
+    // Lazy frames decoded are cached up to the given number of bytes,
+    // the least recently used ones being evicted first. Evictions
+    // invalidate references to the frames. Frames accessed for
+    // writing are stored back to their source when evicted, or kept
+    // out of the cache if it cannot store them. Zero keeps all of
+    // them.
+    void set_cache_size(size_t const bytes);
+    size_t cache_size() const;
+    FrameCacheStats cache_stats() const;
+    // Hints that a frame will not be accessed again soon, so that it
+    // is evicted before any other
+    void mark_done(size_t const index);
+    // Physical time of a frame, in picoseconds. Lazy frames have the
+    // times known to their source without decoding them.
+    double time(size_t const index) const;
+    // First frame at or after the given time. Times are assumed to
+    // be ascending.
+    std::optional<size_t> frame_at(double const time) const;
 
-    Timestep const& timestep(size_t const index) const {
-        return m_timestep[index];
-    }
+private:
+    // Evenly spaced frame times
+    struct TimeRun
+    {
+        size_t first;
+        size_t count;
+        double start;
+        double step;
+    };
 
-    void add_timestep(Timestep &&ts)
+    struct LazyFrame
     {
-        m_timestep.push_back(std::forward<Timestep>(ts));
-    }
+        std::shared_ptr<internal::FrameSource> source;
+        size_t index;
+        // Position in the cache while decoded
+        std::optional<std::list<size_t>::iterator> cached = std::nullopt;
+        // Hash of the frame when first accessed for writing since
+        // decoded, which tells if it was changed
+        std::optional<size_t> written = std::nullopt;
+    };
 
-private:
-    std::vector<Timestep> m_timestep;
+    // Frames loaded for writing are stored back to their source
+    // when released
+    void load(size_t const index, bool const write = false) const;
+    void add_time(double const time);
+    // Gives the buffer of a decoded frame back to the pool, once its
+    // changes are stored
+    void release(size_t const index) const;
+    void evict() const;
+    // Whether the frame may be dropped by loading another one
+    bool transient(size_t const index) const;
+    TimeSeries transpose(size_t const num_threads) const;
+
+    mutable std::vector<Timestep> m_timestep;
+    // Frames already in memory have no source
+    mutable std::vector<LazyFrame> m_lazy;
+    std::shared_ptr<internal::TimestepPool> m_pool;
+    float m_precision;
+    std::shared_ptr<internal::CompressedFrames> m_compressed;
+    bool m_quantization;
+    std::shared_ptr<internal::QuantizedFrames> m_quantized;
+    size_t m_chunk_frames;
+    std::shared_ptr<internal::FrameChunks> m_chunks;
+    // Frame decoded from a non-persistent source
+    mutable std::optional<size_t> m_scratch;
+    size_t m_cache_size;
+    // Cached frames, from the next to evict to the last used
+    mutable std::list<size_t> m_cache;
+    mutable FrameCacheStats m_cache_stats;
+    std::vector<index_t> m_atoms;
+    // Column of each atom of the system when there is a subset
+    std::vector<index_t> m_columns;
+    mutable std::optional<TimeSeries> m_series;
+    std::vector<TimeRun> m_times;
+    // Guards the mutable state above. Recursive, since building the
+    // time series loads frames, and held by pointer so that
+    // trajectories can be moved.
+    std::unique_ptr<std::recursive_mutex> m_mutex;
 };
 
 } // namespace mol
@@ -0,0 +1,54 @@
+#ifndef TRAJECTORYWRITER_HPP
+#define TRAJECTORYWRITER_HPP
+
+#include <molpp/AtomSel.hpp>
+#include <molpp/Timestep.hpp>
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+namespace mol {
+
+namespace internal {
+class MolWriter;
+class TimestepRing;
+}
+
+// Writes frames of a selection to XTC, TRR, DCD or PDB files. Frames are
+// copied into a bounded queue and encoded on a background thread, so
+// writing only blocks when the queue is full. Errors are raised by the
+// next write or by close().
+class TrajectoryWriter
+{
+public:
+    TrajectoryWriter(std::string const& file_name, AtomSel const& atoms, size_t const queue_size = 8);
+    TrajectoryWriter(TrajectoryWriter const&) = delete;
+    TrajectoryWriter &operator=(TrajectoryWriter const&) = delete;
+    // Waits for queued frames, ignoring errors
+    ~TrajectoryWriter();
+    // Timesteps hold all the atoms of the system, or only those of
+    // its trajectory. Throws a MolError for other sizes, or for
+    // selected atoms without coordinates.
+    void write(Timestep const& timestep);
+    // Frame of the system's trajectory
+    void write(size_t const frame);
+    // Waits for queued frames. Nothing is written afterwards.
+    void close();
+
+private:
+    Timestep &acquire();
+    void run();
+
+    std::string m_file_name;
+    AtomSel m_atoms;
+    std::shared_ptr<internal::MolWriter> m_writer;
+    std::unique_ptr<internal::TimestepRing> m_ring;
+    std::thread m_thread;
+    std::atomic<bool> m_failed;
+    size_t m_count;
+};
+
+} // namespace mol
+
+#endif // TRAJECTORYWRITER_HPP
@@ -0,0 +1,35 @@
+#ifndef UNITCELL_HPP
+#define UNITCELL_HPP
+
+#include <molpp/MolppCore.hpp>
+
+namespace mol {
+
+using Box3 = Eigen::Matrix<position_t, 3, 3>;
+
+// Periodic box of a frame. Lengths are in angstroms and angles (alpha,
+// beta and gamma) in degrees. Zero lengths mean no periodicity.
+class UnitCell
+{
+public:
+    UnitCell();
+    UnitCell(Point3 const& lengths, Point3 const& angles = {90, 90, 90});
+    // Box vectors as columns
+    static UnitCell from_vectors(Box3 const& vectors);
+
+    Point3 const& lengths() const { return m_lengths; }
+    Point3 const& angles() const { return m_angles; }
+    bool is_periodic() const;
+    bool is_orthorhombic() const;
+    // Box vectors as columns, with the first one along x and
+    // the second one in the xy plane
+    Box3 vectors() const;
+
+private:
+    Point3 m_lengths;
+    Point3 m_angles;
+};
+
+} // namespace mol
+
+#endif // UNITCELL_HPP
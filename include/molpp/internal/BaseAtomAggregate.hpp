@@ -17,8 +17,8 @@ class MolData;
 class BaseAtomAggregate
 {
 public:
-    using coords_type = Eigen::IndexedView<Coord3, Eigen::internal::AllRange<3>, std::vector<index_t>>;
-    using const_coords_type = const Eigen::IndexedView<Coord3, Eigen::internal::AllRange<3>, std::vector<index_t>>;
+    using coords_type = Eigen::IndexedView<Coord3Map, Eigen::internal::AllRange<3>, std::vector<index_t>>;
+    using const_coords_type = const Eigen::IndexedView<ConstCoord3Map, Eigen::internal::AllRange<3>, std::vector<index_t>>;
 
     BaseAtomAggregate() = default;
 
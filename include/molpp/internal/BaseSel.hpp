@@ -18,7 +18,9 @@ class MolData;
 class BaseSel
 {
 public:
-    using coords_type = Eigen::IndexedView<Coord3, Eigen::internal::AllRange<3>, std::vector<index_t>>;
+    using coords_type = Eigen::IndexedView<Coord3Map, Eigen::internal::AllRange<3>, std::vector<index_t>>;
+    using const_coords_type = const Eigen::IndexedView<ConstCoord3Map, Eigen::internal::AllRange<3>, std::vector<index_t>>;
+    using time_series_type = Eigen::IndexedView<ConstTimeSeriesMap, Eigen::internal::AllRange<Eigen::Dynamic>, std::vector<index_t>>;
 
     BaseSel() = delete;
     BaseSel(BaseSel &&) = default;
@@ -49,9 +51,15 @@ public:
         return m_index.indices();
     }
 
+    // When only some atoms have coordinates, the timestep columns
+    // do not match atom indices. See Trajectory::columns().
     Timestep& timestep();
+    // Read only, so that transient frames are not stored back
+    Timestep const& timestep() const;
 
 protected:
+    std::vector<index_t> columns(std::vector<index_t> const &atom_indices) const;
+    time_series_type time_series(std::vector<index_t> const &atom_indices) const;
     std::vector<index_t> bonded(std::vector<index_t> const &atom_indices) const;
     std::vector<std::shared_ptr<mol::Bond>> bonds(std::vector<index_t> const &atom_indices);
 
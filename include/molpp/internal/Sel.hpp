@@ -47,6 +47,8 @@ public:
     using iterator = Iterator<Type>;
     using const_iterator = Iterator<const Type>;
     using BaseSel::coords_type;
+    using BaseSel::const_coords_type;
+    using BaseSel::time_series_type;
 
     Sel() = delete;
     Sel(Sel &&) = default;
@@ -124,7 +126,20 @@ public:
     coords_type coords()
     {
         Derived &derived = static_cast<Derived &>(*this);
-        return timestep().coords()(Eigen::all, derived.atom_indices());
+        return timestep().coords()(Eigen::all, columns(derived.atom_indices()));
+    }
+
+    const_coords_type coords() const
+    {
+        Derived const& derived = static_cast<Derived const&>(*this);
+        return timestep().coords()(Eigen::all, columns(derived.atom_indices()));
+    }
+
+    // Coordinates of each atom over all frames. See Trajectory::time_series().
+    time_series_type time_series()
+    {
+        Derived &derived = static_cast<Derived &>(*this);
+        return BaseSel::time_series(derived.atom_indices());
     }
 
     Derived bonded()
@@ -4,6 +4,7 @@
 #include <molpp/MolppCore.hpp>
 #include <vector>
 #include <string>
+#include <functional>
 
 namespace mol::internal {
 
@@ -48,7 +49,40 @@ public:
     std::string &altloc(index_t const index) { return m_altloc[index]; }
     std::string const &altloc(index_t const index) const { return m_altloc[index]; }
 
+    // Whole columns are filled in one pass from a random access range of
+    // at least size() records, the projection (a callable or a member
+    // pointer) giving the value of each atom.
+    template <typename Records, typename Projection>
+    void fill_residues(Records const& records, Projection const& projection) { fill(m_residue, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_atomics(Records const& records, Projection const& projection) { fill(m_atomic, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_occupancies(Records const& records, Projection const& projection) { fill(m_occupancy, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_tempfactors(Records const& records, Projection const& projection) { fill(m_tempfactor, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_masses(Records const& records, Projection const& projection) { fill(m_mass, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_charges(Records const& records, Projection const& projection) { fill(m_charge, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_radii(Records const& records, Projection const& projection) { fill(m_radius, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_names(Records const& records, Projection const& projection) { fill(m_name, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_types(Records const& records, Projection const& projection) { fill(m_type, records, projection); }
+    template <typename Records, typename Projection>
+    void fill_altlocs(Records const& records, Projection const& projection) { fill(m_altloc, records, projection); }
+
 private:
+    template <typename Column, typename Records, typename Projection>
+    void fill(Column &column, Records const& records, Projection const& projection)
+    {
+        for (size_t i = 0; i < m_num_atoms; ++i)
+        {
+            column[i] = std::invoke(projection, records[i]);
+        }
+    }
+
     size_t m_num_atoms;
     std::vector<index_t> m_residue;
     std::vector<index_t> m_atomic;
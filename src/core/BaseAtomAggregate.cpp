@@ -25,7 +25,8 @@ BaseAtomAggregate::coords_type BaseAtomAggregate::coords(std::vector<index_t>&&
     {
         throw mol::MolError("Invalid frame");
     }
-    return m_data->trajectory().timestep(*m_frame).coords()(Eigen::all, std::forward<std::vector<index_t>>(atom_indices));
+    Trajectory &trajectory = m_data->trajectory();
+    return trajectory.timestep(*m_frame).coords()(Eigen::all, trajectory.columns(atom_indices));
 }
 
 BaseAtomAggregate::const_coords_type BaseAtomAggregate::coords(std::vector<index_t>&& atom_indices) const
@@ -34,7 +35,9 @@ BaseAtomAggregate::const_coords_type BaseAtomAggregate::coords(std::vector<index
     {
         throw mol::MolError("Invalid frame");
     }
-    return m_data->trajectory().timestep(*m_frame).coords()(Eigen::all, std::forward<std::vector<index_t>>(atom_indices));
+    // Read only, so that transient frames are not stored back
+    Trajectory const& trajectory = m_data->trajectory();
+    return trajectory.timestep(*m_frame).coords()(Eigen::all, trajectory.columns(atom_indices));
 }
 
 std::vector<std::shared_ptr<Bond>> BaseAtomAggregate::bonds(std::vector<index_t> const& atom_indices)
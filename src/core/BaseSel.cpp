@@ -31,6 +31,27 @@ Timestep& BaseSel::timestep()
     return m_data->trajectory().timestep(m_frame.value());
 }
 
+Timestep const& BaseSel::timestep() const
+{
+    if (!m_frame)
+    {
+        throw mol::MolError("Invalid frame");
+    }
+    Trajectory const& trajectory = m_data->trajectory();
+    return trajectory.timestep(m_frame.value());
+}
+
+std::vector<index_t> BaseSel::columns(std::vector<index_t> const &atom_indices) const
+{
+    return m_data->trajectory().columns(atom_indices);
+}
+
+BaseSel::time_series_type BaseSel::time_series(std::vector<index_t> const &atom_indices) const
+{
+    Trajectory const& trajectory = m_data->trajectory();
+    return trajectory.time_series()(Eigen::all, trajectory.columns(atom_indices));
+}
+
 std::vector<index_t> BaseSel::bonded(std::vector<index_t> const &atom_indices) const
 {
     return m_data->bonds().bonded(atom_indices.begin(), atom_indices.end());
@@ -30,6 +30,12 @@ public:
         return m_graph.edges_size();
     }
 
+    // All bonds, in the order they were added
+    auto const bonds() const
+    {
+        return m_graph.edges();
+    }
+
     template <class Iterator>
     std::vector<std::shared_ptr<Bond>> bonds(Iterator it, Iterator end);
     template <class Iterator>
@@ -0,0 +1,246 @@
+#include "core/CompressedFrames.hpp"
+#include <molpp/MolError.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace mol;
+using namespace mol::internal;
+
+namespace {
+
+void write_varint(std::vector<uint8_t> &data, int64_t const value)
+{
+    // Zigzag coding keeps small negative values short
+    uint64_t bits = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+    while (bits >= 0x80)
+    {
+        data.push_back(uint8_t(bits) | 0x80);
+        bits >>= 7;
+    }
+    data.push_back(uint8_t(bits));
+}
+
+int64_t read_varint(uint8_t const *&data)
+{
+    uint64_t bits = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        uint8_t const byte = *(data++);
+        bits |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    return int64_t(bits >> 1) ^ -int64_t(bits & 1);
+}
+
+} // namespace
+
+CompressedFrames::CompressedFrames(size_t const num_atoms, float const precision, size_t const block_size)
+: m_num_atoms { num_atoms },
+  m_precision { precision },
+  m_block_size { block_size ? block_size : 1 },
+  m_last(3 * num_atoms, 0),
+  m_decoded(3 * num_atoms, 0)
+{
+    if (precision <= 0)
+    {
+        throw mol::MolError("Invalid precision");
+    }
+}
+
+size_t CompressedFrames::num_atoms() const
+{
+    return m_num_atoms;
+}
+
+size_t CompressedFrames::num_frames() const
+{
+    return m_offsets.size();
+}
+
+bool CompressedFrames::persistent() const
+{
+    return false;
+}
+
+double CompressedFrames::time(size_t const index)
+{
+    return m_times.at(index);
+}
+
+size_t CompressedFrames::add(Timestep const& timestep)
+{
+    if ((size_t)timestep.coords().cols() != m_num_atoms)
+    {
+        throw mol::MolError("Trajectory with wrong number of atoms");
+    }
+
+    size_t const index = m_offsets.size();
+    bool const first = (index % m_block_size) == 0;
+    std::vector<int64_t> values;
+    quantize(timestep, values);
+
+    if (first)
+    {
+        m_blocks.emplace_back();
+    }
+    m_offsets.push_back(m_blocks.back().size());
+    m_cells.push_back(timestep.cell());
+    m_times.push_back(timestep.time());
+    encode(values, first ? nullptr : &m_last, m_blocks.back());
+    m_last = std::move(values);
+
+    return index;
+}
+
+void CompressedFrames::read(size_t const index, Timestep &timestep)
+{
+    if (index >= m_offsets.size())
+    {
+        throw mol::MolError("Invalid frame");
+    }
+
+    size_t const num_atoms = timestep.is_view() ? 0 : timestep.coords().cols();
+    if (num_atoms == 0)
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if (num_atoms != m_num_atoms)
+    {
+        throw mol::MolError("Trajectory with wrong number of atoms");
+    }
+
+    decode(index);
+    position_t *coords = timestep.coords().data();
+    for (size_t i = 0; i < 3 * m_num_atoms; ++i)
+    {
+        coords[i] = m_decoded[i] * m_precision;
+    }
+    timestep.cell() = m_cells[index];
+    timestep.time() = m_times[index];
+}
+
+bool CompressedFrames::write(size_t const index, Timestep const& timestep)
+{
+    if (index >= m_offsets.size() || (size_t)timestep.coords().cols() != m_num_atoms)
+    {
+        return false;
+    }
+
+    m_cells[index] = timestep.cell();
+    m_times[index] = timestep.time();
+
+    // Unchanged frames are usually still decoded
+    quantize(timestep, m_written);
+    decode(index);
+    if (m_written == m_decoded)
+    {
+        return true;
+    }
+
+    // Frames of the block are coded against each other, so the
+    // whole block is encoded again
+    size_t const block = index / m_block_size;
+    size_t const block_start = block * m_block_size;
+    size_t const block_end = std::min(block_start + m_block_size, m_offsets.size());
+    std::vector<std::vector<int64_t>> frames;
+    for (size_t frame = block_start; frame < block_end; ++frame)
+    {
+        if (frame == index)
+        {
+            frames.push_back(m_written);
+        }
+        else
+        {
+            decode(frame);
+            frames.push_back(m_decoded);
+        }
+    }
+
+    std::vector<uint8_t> data;
+    for (size_t frame = block_start; frame < block_end; ++frame)
+    {
+        size_t const i = frame - block_start;
+        m_offsets[frame] = data.size();
+        encode(frames[i], i ? &frames[i - 1] : nullptr, data);
+    }
+    m_blocks[block] = std::move(data);
+
+    if (block_end == m_offsets.size())
+    {
+        m_last = frames.back();
+    }
+    m_decoded = std::move(frames[index - block_start]);
+    m_decoded_index = index;
+
+    return true;
+}
+
+size_t CompressedFrames::compressed_size() const
+{
+    size_t size = 0;
+    for (std::vector<uint8_t> const &block : m_blocks)
+    {
+        size += block.size();
+    }
+    return size;
+}
+
+void CompressedFrames::quantize(Timestep const& timestep, std::vector<int64_t> &values) const
+{
+    position_t const *coords = timestep.coords().data();
+    values.resize(3 * m_num_atoms);
+    for (size_t i = 0; i < 3 * m_num_atoms; ++i)
+    {
+        values[i] = std::llround(coords[i] / m_precision);
+    }
+}
+
+void CompressedFrames::encode(std::vector<int64_t> const& values, std::vector<int64_t> const *previous, std::vector<uint8_t> &data) const
+{
+    for (size_t i = 0; i < 3 * m_num_atoms; ++i)
+    {
+        if (previous)
+        {
+            write_varint(data, values[i] - (*previous)[i]);
+        }
+        else
+        {
+            // Same dimension of the previous atom
+            write_varint(data, values[i] - ((i >= 3) ? values[i - 3] : 0));
+        }
+    }
+}
+
+void CompressedFrames::decode(size_t const index)
+{
+    size_t const block = index / m_block_size;
+    size_t const block_start = block * m_block_size;
+
+    // Later frames of the same block only need their differences
+    size_t frame = block_start;
+    if (m_decoded_index && *m_decoded_index / m_block_size == block && *m_decoded_index <= index)
+    {
+        frame = *m_decoded_index + 1;
+    }
+
+    for (; frame <= index; ++frame)
+    {
+        uint8_t const *data = m_blocks[block].data() + m_offsets[frame];
+        for (size_t i = 0; i < 3 * m_num_atoms; ++i)
+        {
+            int64_t const diff = read_varint(data);
+            if (frame == block_start)
+            {
+                m_decoded[i] = diff + ((i >= 3) ? m_decoded[i - 3] : 0);
+            }
+            else
+            {
+                m_decoded[i] += diff;
+            }
+        }
+    }
+    m_decoded_index = index;
+}
@@ -0,0 +1,66 @@
+#ifndef COMPRESSEDFRAMES_HPP
+#define COMPRESSEDFRAMES_HPP
+
+#include "core/FrameSource.hpp"
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+namespace mol::internal {
+
+// In-memory store of frames quantized to a fixed precision. Within a
+// block of frames, the first one is coded as differences between
+// consecutive atoms and the next ones as differences to the previous
+// frame. Differences are stored as zigzag varints, so that slow
+// moving atoms take one or two bytes per coordinate.
+class CompressedFrames : public FrameSource
+{
+public:
+    CompressedFrames(size_t const num_atoms, float const precision, size_t const block_size = 8);
+    float precision() const { return m_precision; }
+    size_t num_atoms() const override;
+    size_t num_frames() const override;
+    // Decoding costs up to a block of frames, or a single frame when
+    // reading the frames of a block in order
+    void read(size_t const index, Timestep &timestep) override;
+    // Re-encodes the block of the frame if its coordinates changed
+    // at this precision
+    bool write(size_t const index, Timestep const& timestep) override;
+    bool persistent() const override;
+    double time(size_t const index) override;
+    // Returns the index of the new frame
+    size_t add(Timestep const& timestep);
+    // Bytes used by the compressed coordinates
+    size_t compressed_size() const;
+
+private:
+    // Quantized coordinates of a frame
+    void quantize(Timestep const& timestep, std::vector<int64_t> &values) const;
+    // Appends a frame to the data of a block, given the quantized
+    // coordinates of the previous frame of the block, if any
+    void encode(std::vector<int64_t> const& values, std::vector<int64_t> const *previous, std::vector<uint8_t> &data) const;
+    // Brings m_decoded to the given frame
+    void decode(size_t const index);
+
+    size_t m_num_atoms;
+    float m_precision;
+    size_t m_block_size;
+    // Blocks are stored apart, so that one can be re-encoded
+    // without moving the others
+    std::vector<std::vector<uint8_t>> m_blocks;
+    // Start of each frame in its block
+    std::vector<size_t> m_offsets;
+    std::vector<UnitCell> m_cells;
+    std::vector<double> m_times;
+    // Quantized coordinates of the last frame added
+    std::vector<int64_t> m_last;
+    // Quantized coordinates of the last frame written
+    std::vector<int64_t> m_written;
+    // Quantized coordinates of the last frame decoded
+    std::vector<int64_t> m_decoded;
+    std::optional<size_t> m_decoded_index;
+};
+
+} // namespace mol::internal
+
+#endif // COMPRESSEDFRAMES_HPP
@@ -0,0 +1,75 @@
+#include "core/ConcatenatedFrames.hpp"
+#include <molpp/MolError.hpp>
+#include <algorithm>
+
+using namespace mol;
+using namespace mol::internal;
+
+ConcatenatedFrames::ConcatenatedFrames()
+: m_offsets { 0 }
+{}
+
+void ConcatenatedFrames::add(std::shared_ptr<FrameSource> segment)
+{
+    if (!m_segments.empty() && segment->num_atoms() != num_atoms())
+    {
+        throw mol::MolError("Segments with different number of atoms");
+    }
+
+    m_offsets.push_back(m_offsets.back() + segment->num_frames());
+    m_segments.push_back(segment);
+}
+
+size_t ConcatenatedFrames::num_segments() const
+{
+    return m_segments.size();
+}
+
+std::pair<size_t, size_t> ConcatenatedFrames::locate(size_t const index) const
+{
+    if (index >= num_frames())
+    {
+        throw mol::MolError("Out of bounds frame: " + std::to_string(index));
+    }
+
+    // Empty segments share their offset with the next one
+    auto const next = std::upper_bound(m_offsets.begin(), m_offsets.end(), index);
+    size_t const segment = std::distance(m_offsets.begin(), next) - 1;
+    return {segment, index - m_offsets[segment]};
+}
+
+size_t ConcatenatedFrames::num_atoms() const
+{
+    return m_segments.empty() ? 0 : m_segments.front()->num_atoms();
+}
+
+size_t ConcatenatedFrames::num_frames() const
+{
+    return m_offsets.back();
+}
+
+void ConcatenatedFrames::read(size_t const index, Timestep &timestep)
+{
+    auto const [segment, frame] = locate(index);
+    m_segments[segment]->read(frame, timestep);
+}
+
+bool ConcatenatedFrames::write(size_t const index, Timestep const& timestep)
+{
+    auto const [segment, frame] = locate(index);
+    return m_segments[segment]->write(frame, timestep);
+}
+
+double ConcatenatedFrames::time(size_t const index)
+{
+    auto const [segment, frame] = locate(index);
+    return m_segments[segment]->time(frame);
+}
+
+bool ConcatenatedFrames::persistent() const
+{
+    return std::all_of(m_segments.begin(), m_segments.end(), [](auto const& segment)
+    {
+        return segment->persistent();
+    });
+}
@@ -0,0 +1,40 @@
+#ifndef CONCATENATEDFRAMES_HPP
+#define CONCATENATEDFRAMES_HPP
+
+#include "core/FrameSource.hpp"
+#include <vector>
+#include <memory>
+#include <utility>
+
+namespace mol::internal {
+
+// Several frame sources seen as a single one, segment after segment.
+// Frames are looked up through the prefix sums of the segment lengths,
+// so nothing is copied until a frame is read.
+class ConcatenatedFrames : public FrameSource
+{
+public:
+    ConcatenatedFrames();
+    // Throws a MolError if the number of atoms differs from the
+    // previous segments
+    void add(std::shared_ptr<FrameSource> segment);
+    size_t num_segments() const;
+    // Segment holding a frame and the index of the frame within it
+    std::pair<size_t, size_t> locate(size_t const index) const;
+    size_t num_atoms() const override;
+    size_t num_frames() const override;
+    void read(size_t const index, Timestep &timestep) override;
+    bool write(size_t const index, Timestep const& timestep) override;
+    // Only if all the segments are
+    bool persistent() const override;
+    double time(size_t const index) override;
+
+private:
+    std::vector<std::shared_ptr<FrameSource>> m_segments;
+    // First frame of each segment, followed by the number of frames
+    std::vector<size_t> m_offsets;
+};
+
+} // namespace mol::internal
+
+#endif // CONCATENATEDFRAMES_HPP
@@ -0,0 +1,23 @@
+#include "core/FrameChunks.hpp"
+
+using namespace mol;
+using namespace mol::internal;
+
+FrameChunks::FrameChunks(size_t const num_atoms, size_t const chunk_frames)
+: m_num_atoms { num_atoms },
+  m_chunk_frames { chunk_frames ? chunk_frames : 1 },
+  m_used { 0 }
+{}
+
+Timestep FrameChunks::add()
+{
+    size_t const frame_size = 3 * m_num_atoms;
+    if (!m_chunk || m_used == m_chunk_frames)
+    {
+        m_chunk.reset(new position_t[m_chunk_frames * frame_size]);
+        m_used = 0;
+    }
+
+    position_t *coords = m_chunk.get() + frame_size * m_used++;
+    return Timestep(coords, m_num_atoms, m_chunk);
+}
@@ -0,0 +1,31 @@
+#ifndef FRAMECHUNKS_HPP
+#define FRAMECHUNKS_HPP
+
+#include <molpp/Timestep.hpp>
+#include <memory>
+
+namespace mol::internal {
+
+// Frames stored back to back in blocks allocated at once and handed
+// out as timestep views. Consecutive frames of a chunk are 3 * num_atoms
+// coordinates apart. A block is freed with the last view on it.
+class FrameChunks
+{
+public:
+    FrameChunks(size_t const num_atoms, size_t const chunk_frames);
+    size_t num_atoms() const { return m_num_atoms; }
+    size_t chunk_frames() const { return m_chunk_frames; }
+    // View of the next free frame slot
+    Timestep add();
+
+private:
+    size_t m_num_atoms;
+    size_t m_chunk_frames;
+    // Slots used in the current chunk
+    size_t m_used;
+    std::shared_ptr<position_t[]> m_chunk;
+};
+
+} // namespace mol::internal
+
+#endif // FRAMECHUNKS_HPP
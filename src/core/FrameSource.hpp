@@ -0,0 +1,33 @@
+#ifndef FRAMESOURCE_HPP
+#define FRAMESOURCE_HPP
+
+#include <molpp/MolppCore.hpp>
+#include <molpp/Timestep.hpp>
+
+namespace mol::internal {
+
+// Provider of frames that are decoded only when a
+// Trajectory needs them.
+class FrameSource
+{
+public:
+    virtual ~FrameSource() {};
+    virtual size_t num_atoms() const = 0;
+    virtual size_t num_frames() const = 0;
+    // Fills the timestep with the frame's data. Empty timesteps are
+    // allocated by the source. Throws a MolError on failure.
+    virtual void read(size_t const index, Timestep &timestep) = 0;
+    // Whether decoded frames stay in the trajectory. Otherwise, only
+    // the last one accessed is kept and the others are decoded again.
+    virtual bool persistent() const { return true; }
+    // Stores the changes made to a decoded frame. Returns false when
+    // the source cannot keep them.
+    virtual bool write(size_t const, Timestep const&) { return false; }
+    // Time of a frame known without decoding it, in picoseconds.
+    // Zero when unknown.
+    virtual double time(size_t const) { return 0; }
+};
+
+} // namespace mol::internal
+
+#endif // FRAMESOURCE_HPP
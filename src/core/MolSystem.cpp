@@ -4,8 +4,13 @@
 #include <molpp/ResidueSel.hpp>
 #include "core/MolData.hpp"
 #include "readers/MolReader.hpp"
+#include "readers/ReaderFrameSource.hpp"
+#include "readers/Snapshot.hpp"
 #include "guessers/AtomBondGuesser.hpp"
 #include "guessers/ResidueBondGuesser.hpp"
+#include "tools/ThreadPool.hpp"
+#include "core/TimestepPool.hpp"
+#include "core/ConcatenatedFrames.hpp"
 #include <filesystem>
 
 using namespace mol;
@@ -29,22 +34,25 @@ MolSystem::MolSystem(std::string const &topology)
 mol::MolSystem::MolSystem(MolSystem&& other)
 {
     std::swap(m_data, other.m_data);
+    std::swap(m_readers, other.m_readers);
 }
 
 mol::MolSystem::~MolSystem()
 {
 }
 
-void MolSystem::add_trajectory(std::string const& file_name, int begin, int end, int step)
+static std::shared_ptr<MolReader> trajectory_reader(std::string const& file_name)
 {
     auto reader = MolReader::from_file_ext(std::filesystem::path(file_name).extension());
     if (!reader)
     {
         throw mol::MolError("No reader for file " + file_name);
     }
+    return reader;
+}
 
-    MolReader::Status status = reader->read_trajectory(file_name, *m_data, begin, end, step);
-
+static void check_trajectory_status(MolReader::Status const status, std::string const& file_name)
+{
     if (status != MolReader::SUCCESS)
     {
         switch (status)
@@ -58,6 +66,169 @@ void MolSystem::add_trajectory(std::string const& file_name, int begin, int end,
     }
 }
 
+void MolSystem::add_trajectory(std::string const& file_name, int begin, int end, int step)
+{
+    auto reader = trajectory_reader(file_name);
+    m_readers = { reader };
+    MolReader::Status status = reader->read_trajectory(file_name, *m_data, begin, end, step);
+    check_trajectory_status(status, file_name);
+}
+
+void MolSystem::add_trajectory(std::string const& file_name, AtomSel const& atoms, int begin, int end, int step)
+{
+    m_data->trajectory().set_atoms(atoms.indices(), m_data->size());
+    add_trajectory(file_name, begin, end, step);
+}
+
+void MolSystem::add_trajectory_times(std::string const& file_name, double begin, double end, double step)
+{
+    auto reader = trajectory_reader(file_name);
+    m_readers = { reader };
+    MolReader::Status status = reader->read_trajectory_times(file_name, *m_data, begin, end, step);
+    check_trajectory_status(status, file_name);
+}
+
+void MolSystem::add_lazy_trajectory(std::string const& file_name, int begin, int end, int step)
+{
+    auto reader = trajectory_reader(file_name);
+    m_readers = { reader };
+    auto source = std::make_shared<ReaderFrameSource>(reader, file_name);
+    MolReader::Status status = source->open(*m_data, begin, end, step);
+    check_trajectory_status(status, file_name);
+    m_data->trajectory().add_frames(source);
+}
+
+void MolSystem::add_lazy_trajectories(std::vector<std::string> const& file_names, int begin, int end, int step)
+{
+    auto frames = std::make_shared<ConcatenatedFrames>();
+    m_readers.clear();
+    for (std::string const& file_name : file_names)
+    {
+        auto reader = trajectory_reader(file_name);
+        m_readers.push_back(reader);
+        auto source = std::make_shared<ReaderFrameSource>(reader, file_name);
+        MolReader::Status status = source->open(*m_data, begin, end, step);
+        check_trajectory_status(status, file_name);
+        frames->add(source);
+    }
+    m_data->trajectory().add_frames(frames);
+}
+
+void MolSystem::add_trajectories(std::vector<std::string> const& file_names, int begin, int end, int step, size_t num_threads)
+{
+    if (file_names.empty())
+    {
+        return;
+    }
+
+    // Each segment has its own reader and frames
+    Trajectory &trajectory = m_data->trajectory();
+    std::vector<std::vector<Timestep>> segments(file_names.size());
+    std::vector<std::shared_ptr<MolReader>> readers(file_names.size());
+    std::vector<std::future<void>> tasks;
+    {
+        size_t const max_threads = num_threads ? num_threads : std::thread::hardware_concurrency();
+        ThreadPool pool(std::min(max_threads, file_names.size()));
+        for (size_t i = 0; i < file_names.size(); ++i)
+        {
+            tasks.push_back(pool.submit([this, &trajectory, &file_names, &segments, &readers, i, begin, end, step]()
+            {
+                std::string const& file_name = file_names[i];
+                std::vector<Timestep> &segment = segments[i];
+                auto reader = trajectory_reader(file_name);
+                readers[i] = reader;
+                MolReader::Status status = reader->stream_trajectory(file_name, *m_data, [&trajectory, &segment](size_t const, Timestep &ts)
+                {
+                    segment.push_back(trajectory.gather(std::move(ts)));
+                    return true;
+                }, begin, end, step, 0, &trajectory.pool());
+                check_trajectory_status(status, file_name);
+            }));
+        }
+    }
+
+    // Segments that failed still tell how far they went
+    std::erase(readers, nullptr);
+    m_readers = readers;
+
+    // Nothing is added if any segment failed
+    for (std::future<void> &task : tasks)
+    {
+        task.get();
+    }
+
+    for (std::vector<Timestep> &segment : segments)
+    {
+        for (Timestep &ts : segment)
+        {
+            trajectory.add_timestep(std::move(ts));
+        }
+    }
+}
+
+void MolSystem::stream_trajectory(std::string const& file_name, TimestepCallback const& callback, int begin, int end, int step, size_t prefetch)
+{
+    auto reader = trajectory_reader(file_name);
+    m_readers = { reader };
+    MolReader::Status status = reader->stream_trajectory(file_name, *m_data, callback, begin, end, step, prefetch);
+    check_trajectory_status(status, file_name);
+}
+
+void MolSystem::reset_trajectory(bool const keep_buffers)
+{
+    m_data->trajectory().clear(keep_buffers);
+}
+
+void MolSystem::set_trajectory_compression(float const precision)
+{
+    m_data->trajectory().set_compression(precision);
+}
+
+void MolSystem::set_trajectory_quantization(bool const enable)
+{
+    m_data->trajectory().set_quantization(enable);
+}
+
+void MolSystem::set_trajectory_chunk(size_t const num_frames)
+{
+    m_data->trajectory().set_chunk_frames(num_frames);
+}
+
+void MolSystem::set_trajectory_cache(size_t const bytes)
+{
+    m_data->trajectory().set_cache_size(bytes);
+}
+
+FrameCacheStats MolSystem::trajectory_cache_stats() const
+{
+    return m_data->trajectory().cache_stats();
+}
+
+void MolSystem::mark_frame_done(size_t const frame)
+{
+    m_data->trajectory().mark_done(frame);
+}
+
+ReaderStats MolSystem::reader_stats() const
+{
+    ReaderStats stats;
+    for (auto const& reader : m_readers)
+    {
+        stats += reader->stats();
+    }
+    return stats;
+}
+
+double MolSystem::frame_time(size_t const frame) const
+{
+    return m_data->trajectory().time(frame);
+}
+
+Frame MolSystem::frame_at(double const time) const
+{
+    return m_data->trajectory().frame_at(time);
+}
+
 AtomSel MolSystem::atoms(Frame const frame) const
 {
     AtomSel sel(m_data.get());
@@ -87,6 +258,18 @@ AtomSelector MolSystem::selector(std::string const& selection) const
     return AtomSelector(selection, m_data.get());
 }
 
+void MolSystem::save(std::string const& file_name, bool const with_trajectory) const
+{
+    if (with_trajectory && !m_data->trajectory().atoms().empty())
+    {
+        throw mol::MolError("Trajectory without all the atoms");
+    }
+    if (!snapshot::write(*m_data, file_name, with_trajectory))
+    {
+        throw mol::MolError("Error writing file " + file_name);
+    }
+}
+
 void MolSystem::reset_bonds()
 {
     m_data->bonds().clear();
@@ -101,10 +284,13 @@ void MolSystem::guess_bonds(Frame const frame)
     ResidueBondGuesser res_guesser;
     res_guesser.apply(all_residues);
 
-    // Bond heuristics are the last step
-    if (m_data->trajectory().num_frames())
+    // Bond heuristics are the last step, among the atoms with
+    // coordinates
+    Trajectory const& trajectory = m_data->trajectory();
+    if (trajectory.num_frames())
     {
+        AtomSel atoms_with_coords = trajectory.atoms().empty() ? all_atoms : select(trajectory.atoms(), frame);
         AtomBondGuesser atom_guesser;
-        atom_guesser.apply(all_atoms);
+        atom_guesser.apply(atoms_with_coords);
     }
 }
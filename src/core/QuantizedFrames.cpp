@@ -0,0 +1,95 @@
+#include "core/QuantizedFrames.hpp"
+#include <molpp/MolError.hpp>
+
+using namespace mol;
+using namespace mol::internal;
+
+QuantizedFrames::QuantizedFrames(size_t const num_atoms)
+: m_num_atoms { num_atoms }
+{}
+
+size_t QuantizedFrames::num_atoms() const
+{
+    return m_num_atoms;
+}
+
+size_t QuantizedFrames::num_frames() const
+{
+    return m_frames.size();
+}
+
+bool QuantizedFrames::persistent() const
+{
+    return false;
+}
+
+double QuantizedFrames::time(size_t const index)
+{
+    return m_times.at(index);
+}
+
+size_t QuantizedFrames::add(Timestep const& timestep)
+{
+    if ((size_t)timestep.coords().cols() != m_num_atoms)
+    {
+        throw mol::MolError("Trajectory with wrong number of atoms");
+    }
+
+    QuantizedTimestep quantized(timestep);
+    if (!quantized.within_tolerance())
+    {
+        throw mol::MolError("Frame too large to quantize within tolerance");
+    }
+
+    m_frames.push_back(std::move(quantized));
+    m_times.push_back(timestep.time());
+    return m_frames.size() - 1;
+}
+
+void QuantizedFrames::read(size_t const index, Timestep &timestep)
+{
+    if (index >= m_frames.size())
+    {
+        throw mol::MolError("Invalid frame");
+    }
+
+    size_t const num_atoms = timestep.is_view() ? 0 : timestep.coords().cols();
+    if (num_atoms == 0)
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if (num_atoms != m_num_atoms)
+    {
+        throw mol::MolError("Trajectory with wrong number of atoms");
+    }
+
+    QuantizedTimestep const &frame = m_frames[index];
+    timestep.coords() = frame.coords();
+    timestep.cell() = frame.cell();
+    timestep.time() = m_times[index];
+}
+
+bool QuantizedFrames::write(size_t const index, Timestep const& timestep)
+{
+    if (index >= m_frames.size() || (size_t)timestep.coords().cols() != m_num_atoms)
+    {
+        return false;
+    }
+
+    // Frames read and left unchanged are widened the same way
+    QuantizedTimestep &frame = m_frames[index];
+    m_times[index] = timestep.time();
+    if ((frame.coords().array() == timestep.coords().array()).all())
+    {
+        frame.cell() = timestep.cell();
+        return true;
+    }
+
+    QuantizedTimestep quantized(timestep);
+    if (!quantized.within_tolerance())
+    {
+        return false;
+    }
+    frame = std::move(quantized);
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef QUANTIZEDFRAMES_HPP
+#define QUANTIZEDFRAMES_HPP
+
+#include "core/FrameSource.hpp"
+#include <molpp/QuantizedTimestep.hpp>
+#include <vector>
+
+namespace mol::internal {
+
+// In-memory store of frames kept as 16-bit QuantizedTimesteps, which
+// are widened on access.
+class QuantizedFrames : public FrameSource
+{
+public:
+    QuantizedFrames(size_t const num_atoms);
+    size_t num_atoms() const override;
+    size_t num_frames() const override;
+    void read(size_t const index, Timestep &timestep) override;
+    // Frames that no longer fit within the tolerance are not stored
+    bool write(size_t const index, Timestep const& timestep) override;
+    bool persistent() const override;
+    double time(size_t const index) override;
+    // Returns the index of the new frame. Throws a MolError if the
+    // frame does not fit within the tolerance.
+    size_t add(Timestep const& timestep);
+
+private:
+    size_t m_num_atoms;
+    std::vector<QuantizedTimestep> m_frames;
+    std::vector<double> m_times;
+};
+
+} // namespace mol::internal
+
+#endif // QUANTIZEDFRAMES_HPP
@@ -0,0 +1,44 @@
+#include <molpp/QuantizedTimestep.hpp>
+#include <limits>
+
+using namespace mol;
+
+static float const QUANTIZED_MAX = std::numeric_limits<int16_t>::max();
+
+QuantizedTimestep::QuantizedTimestep()
+: m_origin { 0, 0, 0 },
+  m_scale { 1 }
+{}
+
+QuantizedTimestep::QuantizedTimestep(Timestep const& timestep)
+: QuantizedTimestep()
+{
+    ConstCoord3Map const coords = timestep.coords();
+    m_cell = timestep.cell();
+    if (coords.cols() == 0)
+    {
+        return;
+    }
+
+    Point3 const min_coords = coords.rowwise().minCoeff();
+    Point3 const max_coords = coords.rowwise().maxCoeff();
+    float const half_edge = (max_coords - min_coords).maxCoeff() / 2;
+    m_origin = (min_coords + max_coords) / 2;
+    if (half_edge > 0)
+    {
+        m_scale = half_edge / QUANTIZED_MAX;
+    }
+
+    // Clamping only catches rounding at the box edges
+    m_data = ((coords.colwise() - m_origin) / m_scale).array().round()
+             .cwiseMax(-QUANTIZED_MAX).cwiseMin(QUANTIZED_MAX)
+             .cast<int16_t>();
+}
+
+Timestep QuantizedTimestep::decode() const
+{
+    Timestep timestep(size());
+    timestep.coords() = coords();
+    timestep.cell() = m_cell;
+    return timestep;
+}
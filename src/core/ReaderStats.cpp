@@ -0,0 +1,30 @@
+#include <molpp/ReaderStats.hpp>
+#include <sstream>
+
+using namespace mol;
+
+ReaderStats& ReaderStats::operator+=(ReaderStats const& other)
+{
+    bytes_read += other.bytes_read;
+    frames_decoded += other.frames_decoded;
+    frames_skipped += other.frames_skipped;
+    io_time += other.io_time;
+    decode_time += other.decode_time;
+    copy_time += other.copy_time;
+    peak_buffer_bytes += other.peak_buffer_bytes;
+    return *this;
+}
+
+std::string ReaderStats::json() const
+{
+    std::ostringstream out;
+    out << "{\"bytes_read\": " << bytes_read
+        << ", \"frames_decoded\": " << frames_decoded
+        << ", \"frames_skipped\": " << frames_skipped
+        << ", \"io_time\": " << io_time
+        << ", \"decode_time\": " << decode_time
+        << ", \"copy_time\": " << copy_time
+        << ", \"peak_buffer_bytes\": " << peak_buffer_bytes
+        << "}";
+    return out.str();
+}
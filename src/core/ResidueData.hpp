@@ -6,6 +6,7 @@
 #include <string>
 #include <ranges>
 #include <unordered_set>
+#include <iterator>
 
 namespace mol::internal {
 
@@ -99,6 +100,16 @@ public:
         residue.reserve(new_size);
     }
 
+    // Replaces the atoms of a residue
+    template <typename Iterator>
+    void assign(index_t const index, Iterator begin, Iterator end)
+    {
+        indices_type &residue = m_indices[index];
+        residue.clear();
+        residue.reserve(std::distance(begin, end));
+        residue.insert(begin, end);
+    }
+
     void add_atom(index_t const residue, index_t const atom)
     {
         m_indices[residue].insert(atom);
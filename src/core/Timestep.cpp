@@ -1,14 +1,29 @@
 #include <molpp/Timestep.hpp>
+#include <new>
 
 using namespace mol;
 
 Timestep::Timestep()
-: m_num_atoms { 0 }
+: m_num_atoms { 0 },
+  m_data { nullptr },
+  m_map(nullptr, 3, 0),
+  m_time { 0 }
 {}
 
 Timestep::Timestep(size_t const num_atoms)
 : m_num_atoms { num_atoms },
-  m_coords(3, num_atoms)
+  m_coords(3, num_atoms),
+  m_data { m_coords.data() },
+  m_map(m_data, 3, num_atoms),
+  m_time { 0 }
+{}
+
+Timestep::Timestep(position_t *coords, size_t const num_atoms, std::shared_ptr<void const> owner)
+: m_num_atoms { num_atoms },
+  m_data { coords },
+  m_map(coords, 3, num_atoms),
+  m_owner { owner },
+  m_time { 0 }
 {}
 
 Timestep::Timestep(Timestep &&src) noexcept
@@ -28,6 +43,20 @@ Timestep &Timestep::operator=(Timestep &&rhs)
 
 void Timestep::swap(Timestep &rhs)
 {
+    // Swapping Eigen matrices keeps their buffers, so data
+    // pointers remain valid.
     std::swap(this->m_num_atoms, rhs.m_num_atoms);
     std::swap(this->m_coords, rhs.m_coords);
+    std::swap(this->m_data, rhs.m_data);
+    std::swap(this->m_owner, rhs.m_owner);
+    std::swap(this->m_cell, rhs.m_cell);
+    std::swap(this->m_time, rhs.m_time);
+    bind();
+    rhs.bind();
+}
+
+void Timestep::bind()
+{
+    // Maps cannot be reassigned, only rebuilt in place
+    new (&m_map) Coord3Map(m_data, 3, m_num_atoms);
 }
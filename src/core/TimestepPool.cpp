@@ -0,0 +1,50 @@
+#include "core/TimestepPool.hpp"
+
+using namespace mol;
+using namespace mol::internal;
+
+TimestepPool::TimestepPool(size_t const capacity)
+: m_capacity { capacity }
+{}
+
+Timestep TimestepPool::acquire(size_t const num_atoms)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_buffers.rbegin(); it != m_buffers.rend(); ++it)
+    {
+        if ((size_t)it->coords().cols() == num_atoms)
+        {
+            Timestep ts(std::move(*it));
+            m_buffers.erase(std::next(it).base());
+            return ts;
+        }
+    }
+
+    return Timestep();
+}
+
+void TimestepPool::release(Timestep &&timestep)
+{
+    if (timestep.is_view() || timestep.coords().cols() == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_buffers.size() < m_capacity)
+    {
+        m_buffers.push_back(std::move(timestep));
+    }
+}
+
+size_t TimestepPool::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buffers.size();
+}
+
+void TimestepPool::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.clear();
+}
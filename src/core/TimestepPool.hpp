@@ -0,0 +1,37 @@
+#ifndef TIMESTEPPOOL_HPP
+#define TIMESTEPPOOL_HPP
+
+#include <molpp/Timestep.hpp>
+#include <vector>
+#include <mutex>
+
+namespace mol::internal {
+
+// Recycles the buffers of dropped timesteps so that reading
+// frames again does not allocate. Only a few buffers are kept, enough
+// for the batches and prefetching of readers, so that dropping a whole
+// trajectory does not keep it in memory.
+class TimestepPool
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    TimestepPool(size_t const capacity = DEFAULT_CAPACITY);
+    // Returns an empty timestep when there is no buffer to reuse
+    Timestep acquire(size_t const num_atoms);
+    // Views are simply dropped, since they do not own their storage,
+    // and so are buffers beyond the capacity
+    void release(Timestep &&timestep);
+    size_t size() const;
+    size_t capacity() const { return m_capacity; }
+    void clear();
+
+private:
+    size_t m_capacity;
+    std::vector<Timestep> m_buffers;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace mol::internal
+
+#endif // TIMESTEPPOOL_HPP
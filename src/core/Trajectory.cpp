@@ -0,0 +1,551 @@
+#include <molpp/Trajectory.hpp>
+#include "core/FrameSource.hpp"
+#include "core/TimestepPool.hpp"
+#include "core/CompressedFrames.hpp"
+#include "core/QuantizedFrames.hpp"
+#include "core/FrameChunks.hpp"
+#include "tools/ThreadPool.hpp"
+#include <utility>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string_view>
+
+using namespace mol;
+using namespace mol::internal;
+
+namespace {
+constexpr index_t NO_COLUMN = std::numeric_limits<index_t>::max();
+// Transposition block sizes
+constexpr size_t FRAME_BLOCK = 64;
+constexpr size_t ATOM_BLOCK = 64;
+
+// Times are often stored in single precision
+double time_tolerance(double const time)
+{
+    return 1e-6 * std::max(1.0, std::abs(time));
+}
+
+template <class T>
+std::string_view bytes(T const *data, size_t const size)
+{
+    return {reinterpret_cast<char const *>(data), size * sizeof(T)};
+}
+
+// Tells whether a frame accessed for writing was changed
+size_t contents_hash(Timestep const& ts)
+{
+    std::hash<std::string_view> const hash;
+    ConstCoord3Map const coords = ts.coords();
+    double const time = ts.time();
+    size_t value = hash(bytes(coords.data(), coords.size()));
+    for (std::string_view const data : {bytes(ts.cell().lengths().data(), 3), bytes(ts.cell().angles().data(), 3), bytes(&time, 1)})
+    {
+        value ^= hash(data) + 0x9E3779B97F4A7C15ull + (value << 6) + (value >> 2);
+    }
+    return value;
+}
+}
+
+Trajectory::Trajectory()
+: m_pool { std::make_shared<TimestepPool>() },
+  m_precision { 0 },
+  m_quantization { false },
+  m_chunk_frames { 0 },
+  m_cache_size { 0 },
+  m_mutex { std::make_unique<std::recursive_mutex>() }
+{}
+
+Timestep &Trajectory::timestep(size_t const index)
+{
+    load(index, true);
+    return m_timestep[index];
+}
+
+Timestep const& Trajectory::timestep(size_t const index) const
+{
+    load(index);
+    return m_timestep[index];
+}
+
+void Trajectory::add_timestep(Timestep &&ts)
+{
+    m_series.reset();
+    ts = gather(std::forward<Timestep>(ts));
+    if (m_quantization && m_precision <= 0)
+    {
+        size_t const num_atoms = ts.coords().cols();
+        if (!m_quantized || m_quantized->num_atoms() != num_atoms)
+        {
+            m_quantized = std::make_shared<QuantizedFrames>(num_atoms);
+        }
+
+        // Frames out of tolerance are rejected before changing anything
+        size_t const index = m_quantized->add(ts);
+        add_time(ts.time());
+        m_pool->release(std::forward<Timestep>(ts));
+        m_timestep.emplace_back();
+        m_lazy.push_back({m_quantized, index});
+        return;
+    }
+
+    if (m_precision > 0)
+    {
+        size_t const num_atoms = ts.coords().cols();
+        if (!m_compressed || m_compressed->num_atoms() != num_atoms)
+        {
+            m_compressed = std::make_shared<CompressedFrames>(num_atoms, m_precision);
+        }
+
+        size_t const index = m_compressed->add(ts);
+        add_time(ts.time());
+        m_pool->release(std::forward<Timestep>(ts));
+        m_timestep.emplace_back();
+        m_lazy.push_back({m_compressed, index});
+        return;
+    }
+
+    add_time(ts.time());
+    if (m_chunk_frames)
+    {
+        size_t const num_atoms = ts.coords().cols();
+        if (!m_chunks || m_chunks->num_atoms() != num_atoms)
+        {
+            m_chunks = std::make_shared<FrameChunks>(num_atoms, m_chunk_frames);
+        }
+
+        // The buffer read goes back to the pool for the next frame
+        Timestep slot = m_chunks->add();
+        slot.coords() = ts.coords();
+        slot.cell() = ts.cell();
+        slot.time() = ts.time();
+        m_pool->release(std::forward<Timestep>(ts));
+        m_timestep.push_back(std::move(slot));
+        m_lazy.push_back({nullptr, 0});
+        return;
+    }
+
+    m_timestep.push_back(std::forward<Timestep>(ts));
+    m_lazy.push_back({nullptr, 0});
+}
+
+void Trajectory::add_frames(std::shared_ptr<FrameSource> source)
+{
+    m_series.reset();
+    size_t const num_frames = source->num_frames();
+    m_timestep.reserve(m_timestep.size() + num_frames);
+    m_lazy.reserve(m_lazy.size() + num_frames);
+
+    for (size_t i = 0; i < num_frames; ++i)
+    {
+        add_time(source->time(i));
+        m_timestep.emplace_back();
+        m_lazy.push_back({source, i});
+    }
+}
+
+void Trajectory::clear(bool const keep_buffers)
+{
+    if (keep_buffers)
+    {
+        for (Timestep &ts : m_timestep)
+        {
+            m_pool->release(std::move(ts));
+        }
+    }
+    else
+    {
+        m_pool->clear();
+    }
+
+    m_timestep.clear();
+    m_lazy.clear();
+    m_compressed.reset();
+    m_quantized.reset();
+    m_chunks.reset();
+    m_series.reset();
+    m_scratch.reset();
+    m_cache.clear();
+    m_cache_stats.bytes = 0;
+    m_times.clear();
+    m_atoms.clear();
+    m_columns.clear();
+}
+
+TimestepPool &Trajectory::pool() const
+{
+    return *m_pool;
+}
+
+void Trajectory::set_compression(float const precision)
+{
+    if (precision < 0)
+    {
+        throw mol::MolError("Invalid precision");
+    }
+
+    m_precision = precision;
+    m_compressed.reset();
+}
+
+float Trajectory::compression() const
+{
+    return m_precision;
+}
+
+void Trajectory::set_quantization(bool const enable)
+{
+    m_quantization = enable;
+    m_quantized.reset();
+}
+
+bool Trajectory::quantization() const
+{
+    return m_quantization;
+}
+
+void Trajectory::set_chunk_frames(size_t const num_frames)
+{
+    m_chunk_frames = num_frames;
+    m_chunks.reset();
+}
+
+size_t Trajectory::chunk_frames() const
+{
+    return m_chunk_frames;
+}
+
+void Trajectory::set_atoms(std::vector<index_t> const& indices, size_t const num_atoms)
+{
+    // A subset of all the atoms is no subset
+    bool const subset = indices.size() != num_atoms;
+    if (num_frames() && (subset ? indices != m_atoms : !m_atoms.empty()))
+    {
+        throw mol::MolError("Trajectory frames have other atoms");
+    }
+    if (!indices.empty() && indices.back() >= num_atoms)
+    {
+        throw mol::MolError("Out of bounds index: " + std::to_string(indices.back()));
+    }
+
+    m_atoms.clear();
+    m_columns.clear();
+    if (subset)
+    {
+        m_atoms = indices;
+        m_columns.assign(num_atoms, NO_COLUMN);
+        for (size_t i = 0; i < m_atoms.size(); ++i)
+        {
+            m_columns[m_atoms[i]] = i;
+        }
+    }
+}
+
+std::vector<index_t> const& Trajectory::atoms() const
+{
+    return m_atoms;
+}
+
+std::vector<index_t> Trajectory::columns(std::vector<index_t> const& indices) const
+{
+    if (m_columns.empty())
+    {
+        return indices;
+    }
+
+    std::vector<index_t> columns;
+    columns.reserve(indices.size());
+    for (index_t const index : indices)
+    {
+        if (index >= m_columns.size() || m_columns[index] == NO_COLUMN)
+        {
+            throw mol::MolError("No coordinates for atom " + std::to_string(index));
+        }
+        columns.push_back(m_columns[index]);
+    }
+    return columns;
+}
+
+Timestep Trajectory::gather(Timestep &&ts) const
+{
+    if (m_columns.empty() || (size_t)ts.coords().cols() != m_columns.size())
+    {
+        return std::forward<Timestep>(ts);
+    }
+
+    Timestep compact = m_pool->acquire(m_atoms.size());
+    if ((size_t)compact.coords().cols() != m_atoms.size())
+    {
+        compact = Timestep(m_atoms.size());
+    }
+    compact.coords() = ts.coords()(Eigen::all, m_atoms);
+    compact.cell() = ts.cell();
+    compact.time() = ts.time();
+    m_pool->release(std::forward<Timestep>(ts));
+    return compact;
+}
+
+ConstTimeSeriesMap Trajectory::time_series(size_t const num_threads) const
+{
+    std::lock_guard const lock(*m_mutex);
+    if (!m_series)
+    {
+        m_series = transpose(num_threads);
+    }
+    return ConstTimeSeriesMap(m_series->data(), m_series->rows(), m_series->cols());
+}
+
+TimeSeries Trajectory::transpose(size_t const num_threads) const
+{
+    size_t const num_frames = m_timestep.size();
+    size_t const num_atoms = num_frames ? timestep(0).coords().cols() : 0;
+    TimeSeries series(3 * num_frames, num_atoms);
+    if (!num_frames || !num_atoms)
+    {
+        return series;
+    }
+
+    // Each task fills the columns of a range of atoms
+    ThreadPool pool(num_threads);
+    size_t const atoms_per_task = (num_atoms + pool.size() - 1) / pool.size();
+
+    // Frames are loaded a block at a time. Those decoded into the
+    // scratch frame are copied, since loading the next one drops them.
+    size_t const block_frames = std::min(FRAME_BLOCK, num_frames);
+    std::vector<position_t const *> frames(block_frames);
+    Coord3 scratch;
+    for (size_t first = 0; first < num_frames; first += block_frames)
+    {
+        size_t const count = std::min(block_frames, num_frames - first);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ConstCoord3Map const coords = timestep(first + i).coords();
+            if ((size_t)coords.cols() != num_atoms)
+            {
+                throw mol::MolError("Frames with different number of atoms");
+            }
+
+            frames[i] = coords.data();
+            if (transient(first + i))
+            {
+                if (!scratch.size())
+                {
+                    scratch.resize(3, num_atoms * block_frames);
+                }
+                scratch.middleCols(i * num_atoms, num_atoms) = coords;
+                frames[i] = scratch.data() + 3 * i * num_atoms;
+            }
+        }
+
+        std::vector<std::future<void>> tasks;
+        for (size_t begin = 0; begin < num_atoms; begin += atoms_per_task)
+        {
+            size_t const end = std::min(begin + atoms_per_task, num_atoms);
+            tasks.push_back(pool.submit([&series, &frames, first, count, begin, end]()
+            {
+                for (size_t block = begin; block < end; block += ATOM_BLOCK)
+                {
+                    size_t const block_end = std::min(block + ATOM_BLOCK, end);
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        position_t const *frame = frames[i];
+                        for (size_t atom = block; atom < block_end; ++atom)
+                        {
+                            position_t *out = series.col(atom).data() + 3 * (first + i);
+                            out[0] = frame[3 * atom];
+                            out[1] = frame[3 * atom + 1];
+                            out[2] = frame[3 * atom + 2];
+                        }
+                    }
+                }
+            }));
+        }
+
+        for (std::future<void> &task : tasks)
+        {
+            task.get();
+        }
+    }
+
+    return series;
+}
+
+void Trajectory::set_cache_size(size_t const bytes)
+{
+    m_cache_size = bytes;
+    evict();
+}
+
+size_t Trajectory::cache_size() const
+{
+    return m_cache_size;
+}
+
+FrameCacheStats Trajectory::cache_stats() const
+{
+    std::lock_guard const lock(*m_mutex);
+    return m_cache_stats;
+}
+
+void Trajectory::mark_done(size_t const index)
+{
+    std::lock_guard const lock(*m_mutex);
+    LazyFrame &frame = m_lazy.at(index);
+    if (frame.cached)
+    {
+        m_cache.splice(m_cache.begin(), m_cache, *frame.cached);
+    }
+}
+
+double Trajectory::time(size_t const index) const
+{
+    if (index >= num_frames())
+    {
+        throw mol::MolError("Out of bounds frame: " + std::to_string(index));
+    }
+
+    auto const next = std::partition_point(m_times.begin(), m_times.end(), [index](TimeRun const& run)
+    {
+        return run.first <= index;
+    });
+    TimeRun const& run = *std::prev(next);
+    return run.start + (index - run.first) * run.step;
+}
+
+std::optional<size_t> Trajectory::frame_at(double const time) const
+{
+    double const lowest = time - time_tolerance(time);
+    auto const run = std::partition_point(m_times.begin(), m_times.end(), [lowest](TimeRun const& candidate)
+    {
+        return candidate.start + (candidate.count - 1) * candidate.step < lowest;
+    });
+    if (run == m_times.end())
+    {
+        return std::nullopt;
+    }
+    if (run->start >= lowest || run->step <= 0)
+    {
+        return run->first;
+    }
+
+    size_t const offset = std::ceil((lowest - run->start) / run->step);
+    return run->first + std::min(offset, run->count - 1);
+}
+
+void Trajectory::add_time(double const time)
+{
+    size_t first = 0;
+    if (!m_times.empty())
+    {
+        TimeRun &run = m_times.back();
+        if (run.count == 1)
+        {
+            run.step = time - run.start;
+            ++run.count;
+            return;
+        }
+
+        double const expected = run.start + run.count * run.step;
+        if (std::abs(expected - time) <= time_tolerance(time))
+        {
+            ++run.count;
+            return;
+        }
+        first = run.first + run.count;
+    }
+
+    m_times.push_back({first, 1, time, 0});
+}
+
+void Trajectory::load(size_t const index, bool const write) const
+{
+    std::lock_guard const lock(*m_mutex);
+    LazyFrame &frame = m_lazy[index];
+    if (!frame.source)
+    {
+        return;
+    }
+
+    if (frame.cached)
+    {
+        ++m_cache_stats.hits;
+        m_cache.splice(m_cache.end(), m_cache, *frame.cached);
+        if (write && !frame.written)
+        {
+            frame.written = contents_hash(m_timestep[index]);
+        }
+        return;
+    }
+    if (m_scratch == index)
+    {
+        ++m_cache_stats.hits;
+        if (write && !frame.written)
+        {
+            frame.written = contents_hash(m_timestep[index]);
+        }
+        return;
+    }
+
+    ++m_cache_stats.misses;
+    bool const persistent = frame.source->persistent();
+    if (!persistent && m_scratch)
+    {
+        // Stored while the source still has it decoded
+        release(*std::exchange(m_scratch, std::nullopt));
+    }
+
+    Timestep ts = m_pool->acquire(frame.source->num_atoms());
+    frame.source->read(frame.index, ts);
+    m_timestep[index] = gather(std::move(ts));
+    frame.written.reset();
+    if (write)
+    {
+        frame.written = contents_hash(m_timestep[index]);
+    }
+    if (persistent)
+    {
+        frame.cached = m_cache.insert(m_cache.end(), index);
+        m_cache_stats.bytes += m_timestep[index].coords().size() * sizeof(position_t);
+        evict();
+        return;
+    }
+
+    m_scratch = index;
+}
+
+void Trajectory::release(size_t const index) const
+{
+    // Frames whose source cannot store their changes stay in memory
+    LazyFrame &frame = m_lazy[index];
+    bool const changed = frame.written && *frame.written != contents_hash(m_timestep[index]);
+    frame.written.reset();
+    if (!changed || frame.source->write(frame.index, m_timestep[index]))
+    {
+        m_pool->release(std::exchange(m_timestep[index], Timestep()));
+    }
+    else
+    {
+        frame.source.reset();
+    }
+}
+
+void Trajectory::evict() const
+{
+    std::lock_guard const lock(*m_mutex);
+    // The last frame used always stays
+    while (m_cache_size && m_cache_stats.bytes > m_cache_size && m_cache.size() > 1)
+    {
+        size_t const index = m_cache.front();
+        m_cache.pop_front();
+        m_lazy[index].cached.reset();
+        m_cache_stats.bytes -= m_timestep[index].coords().size() * sizeof(position_t);
+        release(index);
+        ++m_cache_stats.evictions;
+    }
+}
+
+bool Trajectory::transient(size_t const index) const
+{
+    return m_scratch == index || (m_cache_size && m_lazy[index].cached);
+}
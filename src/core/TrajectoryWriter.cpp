@@ -0,0 +1,128 @@
+#include <molpp/TrajectoryWriter.hpp>
+#include <molpp/MolError.hpp>
+#include "writers/MolWriter.hpp"
+#include "core/MolData.hpp"
+#include "readers/TimestepRing.hpp"
+#include <filesystem>
+
+using namespace mol;
+using namespace mol::internal;
+
+TrajectoryWriter::TrajectoryWriter(std::string const& file_name, AtomSel const& atoms, size_t const queue_size)
+: m_file_name { file_name },
+  m_atoms { atoms },
+  m_failed { false },
+  m_count { 0 }
+{
+    m_writer = MolWriter::from_file_ext(std::filesystem::path(file_name).extension());
+    if (!m_writer)
+    {
+        throw mol::MolError("No writer for file " + file_name);
+    }
+
+    if (m_writer->open(file_name, m_atoms) != MolWriter::SUCCESS)
+    {
+        throw mol::MolError("Error writing file " + file_name);
+    }
+
+    m_ring = std::make_unique<TimestepRing>(queue_size ? queue_size : 1);
+    m_thread = std::thread(&TrajectoryWriter::run, this);
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void TrajectoryWriter::write(Timestep const& timestep)
+{
+    // Timesteps of a trajectory with some of the atoms only hold
+    // their columns
+    Trajectory const& trajectory = m_atoms.data()->trajectory();
+    ConstCoord3Map const coords = timestep.coords();
+    size_t const num_atoms = coords.cols();
+    bool const compact = !trajectory.atoms().empty() && num_atoms == trajectory.atoms().size();
+    if (!compact && num_atoms != m_atoms.data()->size())
+    {
+        throw mol::MolError("Trajectory with wrong number of atoms");
+    }
+    std::vector<index_t> const columns = compact ? trajectory.columns(m_atoms.indices()) : m_atoms.indices();
+
+    Timestep &slot = acquire();
+    slot.coords() = coords(Eigen::all, columns);
+    slot.cell() = timestep.cell();
+    slot.time() = timestep.time();
+    m_ring->publish(m_count++);
+}
+
+void TrajectoryWriter::write(size_t const frame)
+{
+    // The trajectory may only hold some of the atoms
+    m_atoms.set_frame(frame);
+    AtomSel::coords_type const coords = m_atoms.coords();
+
+    Timestep &slot = acquire();
+    slot.coords() = coords;
+    slot.cell() = m_atoms.timestep().cell();
+    slot.time() = m_atoms.timestep().time();
+    m_ring->publish(m_count++);
+}
+
+void TrajectoryWriter::close()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+
+    // The writer thread drains the queue before stopping
+    m_ring->close();
+    m_thread.join();
+    if (m_writer->close() != MolWriter::SUCCESS || m_failed)
+    {
+        throw mol::MolError("Error writing file " + m_file_name);
+    }
+}
+
+Timestep &TrajectoryWriter::acquire()
+{
+    if (!m_thread.joinable())
+    {
+        throw mol::MolError("Writer is closed");
+    }
+
+    // Fails once the writer thread gave up
+    Timestep *slot = m_ring->acquire();
+    if (!slot)
+    {
+        throw mol::MolError("Error writing file " + m_file_name);
+    }
+
+    size_t const num_atoms = m_atoms.size();
+    if ((size_t)slot->coords().cols() != num_atoms)
+    {
+        *slot = Timestep(num_atoms);
+    }
+    return *slot;
+}
+
+void TrajectoryWriter::run()
+{
+    size_t frame = 0;
+    while (Timestep *ts = m_ring->front(frame))
+    {
+        if (m_writer->write_timestep(*ts) != MolWriter::SUCCESS)
+        {
+            m_failed = true;
+            m_ring->close();
+            return;
+        }
+        m_ring->pop();
+    }
+}
@@ -0,0 +1,69 @@
+#include <molpp/UnitCell.hpp>
+#include <cmath>
+#include <algorithm>
+
+using namespace mol;
+
+static double const DEG_TO_RAD = M_PI / 180.0;
+
+UnitCell::UnitCell()
+: m_lengths { 0, 0, 0 },
+  m_angles { 90, 90, 90 }
+{}
+
+UnitCell::UnitCell(Point3 const& lengths, Point3 const& angles)
+: m_lengths { lengths },
+  m_angles { angles }
+{}
+
+UnitCell UnitCell::from_vectors(Box3 const& vectors)
+{
+    Point3 const lengths = vectors.colwise().norm();
+    if ((lengths.array() <= 0).any())
+    {
+        return UnitCell();
+    }
+
+    // Angles between b and c, a and c, and a and b
+    Point3 angles;
+    for (int i = 0; i < 3; ++i)
+    {
+        int const j = (i + 1) % 3;
+        int const k = (i + 2) % 3;
+        double const cosine = vectors.col(j).dot(vectors.col(k)) / (lengths(j) * lengths(k));
+        angles(i) = std::acos(std::clamp(cosine, -1.0, 1.0)) / DEG_TO_RAD;
+    }
+
+    return UnitCell(lengths, angles);
+}
+
+bool UnitCell::is_periodic() const
+{
+    return (m_lengths.array() > 0).all();
+}
+
+bool UnitCell::is_orthorhombic() const
+{
+    return ((m_angles.array() - 90).abs() < 1e-3).all();
+}
+
+Box3 UnitCell::vectors() const
+{
+    if (is_orthorhombic())
+    {
+        return m_lengths.asDiagonal();
+    }
+
+    double const cos_alpha = std::cos(m_angles(0) * DEG_TO_RAD);
+    double const cos_beta = std::cos(m_angles(1) * DEG_TO_RAD);
+    double const cos_gamma = std::cos(m_angles(2) * DEG_TO_RAD);
+    double const sin_gamma = std::sin(m_angles(2) * DEG_TO_RAD);
+    double const cy = (cos_alpha - cos_beta * cos_gamma) / sin_gamma;
+    double const cz = std::sqrt(std::max(0.0, 1 - cos_beta * cos_beta - cy * cy));
+
+    Box3 box;
+    box << m_lengths(0), m_lengths(1) * cos_gamma, m_lengths(2) * cos_beta,
+           0,            m_lengths(1) * sin_gamma, m_lengths(2) * cy,
+           0,            0,                        m_lengths(2) * cz;
+    return box;
+}
@@ -17,7 +17,7 @@ void AtomBondGuesser::apply(AtomSel &atoms) const
 {
     auto const coords = atoms.coords();
     float const max_bond_length = 3.0;
-    SpatialSearch<AtomSel::coords_type> search(coords, max_bond_length + 0.1);
+    SpatialSearch<AtomSel::coords_type> search(coords, max_bond_length + 0.1, atoms.timestep().cell());
     ElementsTable const& elements_table = ELEMENTS_TABLE();
 
     for (auto &[atom1, atom2, distance_sq] : search.pairs(max_bond_length))
@@ -0,0 +1,212 @@
+#include "BINPOSReader.hpp"
+#include "MappedFile.hpp"
+#include "core/MolData.hpp"
+#include <cstring>
+
+using namespace mol::internal;
+
+namespace {
+
+size_t const MAGIC_SIZE = 4;
+
+uint32_t byteswap(uint32_t const value)
+{
+    return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+}
+
+} // namespace
+
+BINPOSReader::BINPOSReader()
+: m_swap { false },
+  m_num_atoms { 0 },
+  m_num_frames { 0 },
+  m_current { 0 }
+{}
+
+BINPOSReader::~BINPOSReader()
+{
+    close();
+}
+
+bool BINPOSReader::can_read(std::string const &file_ext)
+{
+    return file_ext == ".binpos" && MappedFile::supported();
+}
+
+bool BINPOSReader::has_topology() const
+{
+    return false;
+}
+
+bool BINPOSReader::has_trajectory() const
+{
+    return true;
+}
+
+bool BINPOSReader::has_bonds() const
+{
+    return false;
+}
+
+bool BINPOSReader::has_trajectory_metadata() const
+{
+    return false;
+}
+
+bool BINPOSReader::can_seek() const
+{
+    return true;
+}
+
+MolReader::Status BINPOSReader::open(const std::string &file_name)
+{
+    if (m_file)
+    {
+        return INVALID;
+    }
+
+    m_file = std::make_shared<MappedFile>();
+    if (!m_file->open(file_name)
+        || m_file->size() < MAGIC_SIZE + 4
+        || std::memcmp(m_file->data(), "fxyz", MAGIC_SIZE) != 0)
+    {
+        close();
+        return FAILED;
+    }
+
+    // Each frame starts with the number of atoms, which
+    // also tells the byte order
+    uint32_t num_atoms;
+    std::memcpy(&num_atoms, m_file->data() + MAGIC_SIZE, sizeof(num_atoms));
+    m_swap = num_atoms > 1000000000;
+    if (m_swap)
+    {
+        num_atoms = byteswap(num_atoms);
+    }
+    if (num_atoms == 0)
+    {
+        close();
+        return FAILED;
+    }
+
+    m_num_atoms = num_atoms;
+    m_num_frames = (m_file->size() - MAGIC_SIZE) / (4 + 12 * m_num_atoms);
+    m_current = 0;
+    m_read_ahead.map(m_file->data(), m_file->size());
+
+    return SUCCESS;
+}
+
+void BINPOSReader::close()
+{
+    // Timesteps still referencing the mapping keep it alive
+    m_file.reset();
+    m_read_ahead.close();
+    m_swap = false;
+    m_num_atoms = 0;
+    m_num_frames = 0;
+    m_current = 0;
+}
+
+std::unique_ptr<MolData> BINPOSReader::read_atoms()
+{
+    return nullptr;
+}
+
+MolReader::Status BINPOSReader::check_timestep_read(MolData& atom_data)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (atom_data.size() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    return SUCCESS;
+}
+
+MolReader::Status BINPOSReader::skip_timestep()
+{
+    return seek_timestep(m_current + 1);
+}
+
+MolReader::Status BINPOSReader::seek_timestep(size_t const frame)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (frame > m_num_frames)
+    {
+        m_current = m_num_frames;
+        return END;
+    }
+
+    count_skipped(m_current, frame);
+    m_current = frame;
+    return SUCCESS;
+}
+
+MolReader::Status BINPOSReader::read_timestep(Timestep& timestep)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    size_t const num_atoms = timestep.is_view() ? 0 : timestep.coords().cols();
+    if (num_atoms != 0 && num_atoms != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    if (m_current >= m_num_frames)
+    {
+        return END;
+    }
+
+    m_read_ahead.access(frame_offset(m_current), 12 * m_num_atoms);
+
+    // Mapped pages are private, so views can be freely modified
+    position_t *coords = reinterpret_cast<position_t *>(m_file->data() + frame_offset(m_current));
+    if (num_atoms == 0 && !m_swap)
+    {
+        timestep = Timestep(coords, m_num_atoms, m_file);
+    }
+    else
+    {
+        if (num_atoms == 0)
+        {
+            timestep = Timestep(m_num_atoms);
+        }
+
+        StatsTimer timer(m_stats.copy_time);
+        timestep.cell() = UnitCell();
+        timestep.time() = 0;
+        position_t *data = timestep.coords().data();
+        std::memcpy(data, coords, 3 * m_num_atoms * sizeof(position_t));
+        for (size_t i = 0; m_swap && i < 3 * m_num_atoms; ++i)
+        {
+            uint32_t value;
+            std::memcpy(&value, data + i, sizeof(value));
+            value = byteswap(value);
+            std::memcpy(data + i, &value, sizeof(value));
+        }
+    }
+
+    // Views are read from the mapping when used
+    m_stats.bytes_read += 12 * m_num_atoms;
+    ++m_stats.frames_decoded;
+    ++m_current;
+    return SUCCESS;
+}
+
+size_t BINPOSReader::frame_offset(size_t const frame) const
+{
+    // Skips the frame's number of atoms
+    return MAGIC_SIZE + frame * (4 + 12 * m_num_atoms) + 4;
+}
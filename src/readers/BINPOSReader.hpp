@@ -0,0 +1,50 @@
+#ifndef BINPOSREADER_HPP
+#define BINPOSREADER_HPP
+
+#include "MolReader.hpp"
+#include "ReadAhead.hpp"
+#include <string>
+#include <memory>
+
+namespace mol::internal {
+
+class MappedFile;
+
+// Native reader for Amber's BINPOS trajectories. Frames are stored
+// as xyz-ordered floats, so timesteps are handed out as zero-copy
+// views of the memory-mapped file whenever the byte order matches.
+class BINPOSReader : public MolReader
+{
+public:
+    BINPOSReader();
+    ~BINPOSReader();
+    static bool can_read(std::string const &file_ext);
+    bool has_topology() const override;
+    bool has_trajectory() const override;
+    bool has_bonds() const override;
+    bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
+    Status open(const std::string &file_name) override;
+    void close() override;
+    std::unique_ptr<MolData> read_atoms() override;
+    Status check_timestep_read(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
+
+private:
+    size_t frame_offset(size_t const frame) const;
+
+    std::shared_ptr<MappedFile> m_file;
+    ReadAhead m_read_ahead;
+    bool m_swap;
+    size_t m_num_atoms;
+    size_t m_num_frames;
+    size_t m_current;
+};
+
+} // namespace mol::internal
+
+#endif // BINPOSREADER_HPP
@@ -0,0 +1,433 @@
+#include "DCDReader.hpp"
+#include "MappedFile.hpp"
+#include "core/MolData.hpp"
+#include <cstring>
+#include <cmath>
+
+using namespace mol::internal;
+
+namespace {
+
+size_t const HEADER_SIZE = 84;
+size_t const UNIT_CELL_SIZE = 48;
+// AKMA time unit, in picoseconds
+double const AKMA_TIME = 0.04888821;
+
+uint32_t byteswap(uint32_t const value)
+{
+    return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+}
+
+} // namespace
+
+DCDReader::DCDReader()
+: m_swap { false },
+  m_unit_cell { false },
+  m_4d { false },
+  m_num_atoms { 0 },
+  m_first_frame { 0 },
+  m_first_size { 0 },
+  m_frame_size { 0 },
+  m_num_frames { 0 },
+  m_current { 0 },
+  m_first_time { 0 },
+  m_time_step { 0 }
+{}
+
+DCDReader::~DCDReader()
+{
+    close();
+}
+
+bool DCDReader::can_read(std::string const &file_ext)
+{
+    return file_ext == ".dcd" && MappedFile::supported();
+}
+
+bool DCDReader::has_topology() const
+{
+    return false;
+}
+
+bool DCDReader::has_trajectory() const
+{
+    return true;
+}
+
+bool DCDReader::has_bonds() const
+{
+    return false;
+}
+
+bool DCDReader::has_trajectory_metadata() const
+{
+    return false;
+}
+
+bool DCDReader::can_seek() const
+{
+    return true;
+}
+
+MolReader::Status DCDReader::open(const std::string &file_name)
+{
+    if (m_file)
+    {
+        return INVALID;
+    }
+
+    m_file = std::make_shared<MappedFile>();
+    if (!m_file->open(file_name) || !read_header())
+    {
+        close();
+        return FAILED;
+    }
+
+    m_read_ahead.map(m_file->data(), m_file->size());
+    return SUCCESS;
+}
+
+void DCDReader::close()
+{
+    // Timesteps still referencing the mapping keep it alive
+    m_file.reset();
+    m_read_ahead.close();
+    m_free_atoms.clear();
+    m_swap = false;
+    m_unit_cell = false;
+    m_4d = false;
+    m_num_atoms = 0;
+    m_first_frame = 0;
+    m_first_size = 0;
+    m_frame_size = 0;
+    m_num_frames = 0;
+    m_current = 0;
+}
+
+std::unique_ptr<MolData> DCDReader::read_atoms()
+{
+    return nullptr;
+}
+
+MolReader::Status DCDReader::check_timestep_read(MolData& atom_data)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (atom_data.size() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    return SUCCESS;
+}
+
+MolReader::Status DCDReader::skip_timestep()
+{
+    return seek_timestep(m_current + 1);
+}
+
+MolReader::Status DCDReader::seek_timestep(size_t const frame)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (frame > m_num_frames)
+    {
+        m_current = m_num_frames;
+        return END;
+    }
+
+    count_skipped(m_current, frame);
+    m_current = frame;
+    return SUCCESS;
+}
+
+MolReader::Status DCDReader::read_timestep(Timestep& timestep)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (timestep.coords().cols() == 0 || timestep.is_view())
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if ((size_t)timestep.coords().cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    if (m_current >= m_num_frames)
+    {
+        return END;
+    }
+
+    // Mapped pages are read while copying, so copy time includes I/O
+    size_t const offset = m_first_frame + (m_current ? m_first_size + (m_current - 1) * m_frame_size : 0);
+    size_t const size = m_current ? m_frame_size : m_first_size;
+    m_read_ahead.access(offset, size);
+    {
+        StatsTimer timer(m_stats.copy_time);
+        if (!read_frame(m_current, timestep))
+        {
+            return FAILED;
+        }
+    }
+
+    m_stats.bytes_read += size;
+    ++m_stats.frames_decoded;
+    ++m_current;
+    return SUCCESS;
+}
+
+bool DCDReader::frame_time(size_t const frame, double &time)
+{
+    if (!m_file || frame >= m_num_frames)
+    {
+        return false;
+    }
+
+    time = m_first_time + frame * m_time_step;
+    return true;
+}
+
+bool DCDReader::read_header()
+{
+    // Record markers are 32 bits and tell the byte order
+    if (m_file->size() < HEADER_SIZE + 8)
+    {
+        return false;
+    }
+    m_swap = false;
+    if (read_int(0) != (int32_t)HEADER_SIZE)
+    {
+        m_swap = true;
+        if (read_int(0) != (int32_t)HEADER_SIZE)
+        {
+            return false;
+        }
+    }
+
+    size_t offset = 0;
+    size_t size = 0;
+    size_t header = 0;
+    if (!read_record(offset, size, header)
+        || size != HEADER_SIZE
+        || std::memcmp(m_file->data() + header, "CORD", 4) != 0)
+    {
+        return false;
+    }
+    header += 4;
+
+    // Only CHARMM files have the extra block and 4D flags
+    int32_t const num_fixed = read_int(header + 32);
+    bool const charmm = read_int(header + 76) != 0;
+    m_unit_cell = charmm && read_int(header + 40) != 0;
+    m_4d = charmm && read_int(header + 44) == 1;
+
+    // The integration step is a double in X-PLOR files
+    double delta = 0;
+    uint32_t const delta_bits = read_int(header + 36);
+    if (charmm)
+    {
+        float value;
+        std::memcpy(&value, &delta_bits, sizeof(value));
+        delta = value;
+    }
+    else
+    {
+        uint64_t value;
+        std::memcpy(&value, m_file->data() + header + 36, sizeof(value));
+        if (m_swap)
+        {
+            value = (uint64_t(byteswap(value)) << 32) | byteswap(value >> 32);
+        }
+        std::memcpy(&delta, &value, sizeof(delta));
+    }
+    m_first_time = read_int(header + 4) * delta * AKMA_TIME;
+    m_time_step = read_int(header + 8) * delta * AKMA_TIME;
+
+    // Title
+    size_t title = 0;
+    if (!read_record(offset, size, title) || size < 4 || (size - 4) % 80 != 0)
+    {
+        return false;
+    }
+
+    size_t atoms = 0;
+    if (!read_record(offset, size, atoms) || size != 4)
+    {
+        return false;
+    }
+    int32_t const num_atoms = read_int(atoms);
+    if (num_atoms <= 0 || num_fixed < 0 || num_fixed >= num_atoms)
+    {
+        return false;
+    }
+    m_num_atoms = num_atoms;
+
+    // One-based indices of the free atoms
+    size_t const num_free = num_atoms - num_fixed;
+    m_free_atoms.clear();
+    if (num_fixed > 0)
+    {
+        size_t free_atoms = 0;
+        if (!read_record(offset, size, free_atoms) || size != 4 * num_free)
+        {
+            return false;
+        }
+        m_free_atoms.resize(num_free);
+        for (size_t i = 0; i < num_free; ++i)
+        {
+            m_free_atoms[i] = read_int(free_atoms + 4 * i) - 1;
+            if (m_free_atoms[i] < 0 || m_free_atoms[i] >= num_atoms)
+            {
+                return false;
+            }
+        }
+    }
+
+    // Frames after the first one only hold the free atoms. The frame
+    // count in the header is not reliable for unfinished files.
+    size_t const num_blocks = m_4d ? 4 : 3;
+    size_t const cell_size = m_unit_cell ? UNIT_CELL_SIZE + 8 : 0;
+    m_first_frame = offset;
+    m_first_size = cell_size + num_blocks * (4 * m_num_atoms + 8);
+    m_frame_size = cell_size + num_blocks * (4 * num_free + 8);
+
+    size_t const file_size = m_file->size();
+    m_num_frames = 0;
+    if (file_size >= m_first_frame + m_first_size)
+    {
+        m_num_frames = 1 + (file_size - m_first_frame - m_first_size) / m_frame_size;
+    }
+    m_current = 0;
+
+    return true;
+}
+
+int32_t DCDReader::read_int(size_t const offset) const
+{
+    uint32_t value;
+    std::memcpy(&value, m_file->data() + offset, sizeof(value));
+    return m_swap ? byteswap(value) : value;
+}
+
+bool DCDReader::read_record(size_t &offset, size_t &size, size_t &data_offset) const
+{
+    size_t const file_size = m_file->size();
+    if (offset + 4 > file_size)
+    {
+        return false;
+    }
+
+    int32_t const length = read_int(offset);
+    if (length < 0 || offset + length + 8 > file_size || read_int(offset + length + 4) != length)
+    {
+        return false;
+    }
+
+    size = length;
+    data_offset = offset + 4;
+    offset += length + 8;
+    return true;
+}
+
+void DCDReader::read_block(size_t const offset, size_t const count, size_t const dim, int32_t const *atoms, position_t *coords) const
+{
+    unsigned char const *data = m_file->data() + offset;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t value;
+        std::memcpy(&value, data + 4 * i, sizeof(value));
+        if (m_swap)
+        {
+            value = byteswap(value);
+        }
+
+        size_t const atom = atoms ? atoms[i] : i;
+        std::memcpy(coords + 3 * atom + dim, &value, sizeof(value));
+    }
+}
+
+mol::UnitCell DCDReader::read_cell(size_t const offset) const
+{
+    // Stored as A, gamma, B, beta, alpha and C
+    double values[6];
+    for (size_t i = 0; i < 6; ++i)
+    {
+        uint64_t value;
+        std::memcpy(&value, m_file->data() + offset + 8 * i, sizeof(value));
+        if (m_swap)
+        {
+            value = (uint64_t(byteswap(value)) << 32) | byteswap(value >> 32);
+        }
+        std::memcpy(&values[i], &value, sizeof(value));
+    }
+
+    double angles[3] = {values[4], values[3], values[1]};
+
+    // Recent CHARMM and NAMD versions store the angles' cosines
+    if (std::abs(angles[0]) <= 1 && std::abs(angles[1]) <= 1 && std::abs(angles[2]) <= 1)
+    {
+        for (double &angle : angles)
+        {
+            angle = 90.0 - std::asin(angle) * 180.0 / M_PI;
+        }
+    }
+
+    return UnitCell(Point3(values[0], values[2], values[5]), Point3(angles[0], angles[1], angles[2]));
+}
+
+bool DCDReader::read_frame(size_t const frame, Timestep &timestep) const
+{
+    position_t *coords = timestep.coords().data();
+    size_t count = m_num_atoms;
+    size_t offset = m_first_frame;
+    int32_t const *atoms = nullptr;
+    if (frame > 0)
+    {
+        // Fixed atoms come from the first frame
+        if (!m_free_atoms.empty())
+        {
+            if (!read_frame(0, timestep))
+            {
+                return false;
+            }
+            count = m_free_atoms.size();
+            atoms = m_free_atoms.data();
+        }
+        offset += m_first_size + (frame - 1) * m_frame_size;
+    }
+
+    size_t size = 0;
+    size_t data = 0;
+    timestep.time() = m_first_time + frame * m_time_step;
+    timestep.cell() = UnitCell();
+    if (m_unit_cell)
+    {
+        if (!read_record(offset, size, data) || size != UNIT_CELL_SIZE)
+        {
+            return false;
+        }
+        timestep.cell() = read_cell(data);
+    }
+
+    for (size_t dim = 0; dim < 3; ++dim)
+    {
+        if (!read_record(offset, size, data) || size != 4 * count)
+        {
+            return false;
+        }
+        read_block(data, count, dim, atoms, coords);
+    }
+
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef DCDREADER_HPP
+#define DCDREADER_HPP
+
+#include "MolReader.hpp"
+#include "ReadAhead.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace mol::internal {
+
+class MappedFile;
+
+// Native reader for CHARMM/NAMD/X-PLOR DCD trajectories. The file is
+// memory-mapped and frames are located by arithmetic, so seeking is
+// O(1). DCD stores X, Y and Z in separate blocks, which are
+// interleaved in a single pass straight from the mapping.
+class DCDReader : public MolReader
+{
+public:
+    DCDReader();
+    ~DCDReader();
+    static bool can_read(std::string const &file_ext);
+    bool has_topology() const override;
+    bool has_trajectory() const override;
+    bool has_bonds() const override;
+    bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
+    Status open(const std::string &file_name) override;
+    void close() override;
+    std::unique_ptr<MolData> read_atoms() override;
+    Status check_timestep_read(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    bool frame_time(size_t const frame, double &time) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
+
+private:
+    bool read_header();
+    int32_t read_int(size_t const offset) const;
+    bool read_record(size_t &offset, size_t &size, size_t &data_offset) const;
+    void read_block(size_t const offset, size_t const count, size_t const dim, int32_t const *atoms, position_t *coords) const;
+    UnitCell read_cell(size_t const offset) const;
+    bool read_frame(size_t const frame, Timestep &timestep) const;
+
+    std::shared_ptr<MappedFile> m_file;
+    ReadAhead m_read_ahead;
+    bool m_swap;
+    bool m_unit_cell;
+    bool m_4d;
+    size_t m_num_atoms;
+    // Atoms not fixed during the simulation, for files with fixed atoms
+    std::vector<int32_t> m_free_atoms;
+    size_t m_first_frame;
+    size_t m_first_size;
+    size_t m_frame_size;
+    size_t m_num_frames;
+    size_t m_current;
+    // In picoseconds
+    double m_first_time;
+    double m_time_step;
+};
+
+} // namespace mol::internal
+
+#endif // DCDREADER_HPP
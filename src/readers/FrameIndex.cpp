@@ -0,0 +1,190 @@
+#include "FrameIndex.hpp"
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <system_error>
+#include <random>
+#include <sstream>
+
+#if __has_include(<unistd.h>)
+#define MOLPP_HAS_GETPID
+#include <unistd.h>
+#endif
+
+using namespace mol::internal;
+
+namespace {
+
+char const MAGIC[8] = {'M', 'O', 'L', 'P', 'P', 'I', 'D', 'X'};
+uint32_t const VERSION = 2;
+
+template <class T>
+void write_value(std::ofstream& stream, T const& value)
+{
+    stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template <class T>
+bool read_value(std::ifstream& stream, T& value)
+{
+    return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// Temporary file next to the index, named after the process and a
+// random suffix, so that processes indexing the same file at once
+// do not write to the same one
+std::string temp_name(std::string const& index_name)
+{
+    std::random_device random;
+    std::ostringstream name;
+    name << index_name << '.';
+#ifdef MOLPP_HAS_GETPID
+    name << getpid() << '.';
+#endif
+    name << std::hex << random() << random() << ".tmp";
+    return name.str();
+}
+
+} // namespace
+
+FrameIndex::FrameIndex()
+: m_offsets{0}
+{}
+
+size_t FrameIndex::size() const
+{
+    return m_offsets.size() - 1;
+}
+
+uint64_t FrameIndex::offset(size_t const frame) const
+{
+    return m_offsets[frame];
+}
+
+uint64_t FrameIndex::frame_size(size_t const frame) const
+{
+    return m_offsets[frame + 1] - m_offsets[frame];
+}
+
+double FrameIndex::time(size_t const frame) const
+{
+    return m_times[frame];
+}
+
+void FrameIndex::add_frame(uint64_t const offset, uint64_t const size, double const time)
+{
+    m_offsets.back() = offset;
+    m_offsets.push_back(offset + size);
+    m_times.push_back(time);
+}
+
+void FrameIndex::clear()
+{
+    m_offsets.assign(1, 0);
+    m_times.clear();
+}
+
+bool FrameIndex::load(std::string const& file_name)
+{
+    clear();
+
+    uint64_t file_size;
+    int64_t file_mtime;
+    if (!file_stamp(file_name, file_size, file_mtime))
+    {
+        return false;
+    }
+
+    std::ifstream stream(sidecar(file_name), std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    uint64_t size, num_offsets;
+    int64_t mtime;
+    if (!stream.read(magic, sizeof(magic))
+        || !std::equal(magic, magic + sizeof(magic), MAGIC)
+        || !read_value(stream, version) || version != VERSION
+        || !read_value(stream, size) || size != file_size
+        || !read_value(stream, mtime) || mtime != file_mtime
+        || !read_value(stream, num_offsets) || num_offsets == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint64_t> offsets(num_offsets);
+    std::vector<double> times(num_offsets - 1);
+    if (!stream.read(reinterpret_cast<char*>(offsets.data()), num_offsets * sizeof(uint64_t))
+        || !stream.read(reinterpret_cast<char*>(times.data()), times.size() * sizeof(double))
+        || offsets.back() > file_size
+        || std::adjacent_find(offsets.begin(), offsets.end(), std::greater_equal<uint64_t>()) != offsets.end())
+    {
+        return false;
+    }
+
+    m_offsets = std::move(offsets);
+    m_times = std::move(times);
+    return true;
+}
+
+bool FrameIndex::save(std::string const& file_name) const
+{
+    uint64_t file_size;
+    int64_t file_mtime;
+    if (!file_stamp(file_name, file_size, file_mtime))
+    {
+        return false;
+    }
+
+    // Write to a temporary file first so concurrent readers never
+    // find a partial index
+    std::string const index_name = sidecar(file_name);
+    std::string const tmp_name = temp_name(index_name);
+    {
+        std::ofstream stream(tmp_name, std::ios::binary | std::ios::trunc);
+        if (!stream)
+        {
+            return false;
+        }
+        stream.write(MAGIC, sizeof(MAGIC));
+        write_value(stream, VERSION);
+        write_value(stream, file_size);
+        write_value(stream, file_mtime);
+        write_value(stream, uint64_t(m_offsets.size()));
+        stream.write(reinterpret_cast<char const*>(m_offsets.data()), m_offsets.size() * sizeof(uint64_t));
+        stream.write(reinterpret_cast<char const*>(m_times.data()), m_times.size() * sizeof(double));
+        if (!stream)
+        {
+            std::error_code error;
+            std::filesystem::remove(tmp_name, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmp_name, index_name, error);
+    if (error)
+    {
+        std::filesystem::remove(tmp_name, error);
+        return false;
+    }
+    return true;
+}
+
+std::string FrameIndex::sidecar(std::string const& file_name)
+{
+    return file_name + ".molppidx";
+}
+
+bool FrameIndex::file_stamp(std::string const& file_name, uint64_t& size, int64_t& mtime)
+{
+    std::error_code error;
+    size = std::filesystem::file_size(file_name, error);
+    if (error)
+    {
+        return false;
+    }
+
+    auto const time = std::filesystem::last_write_time(file_name, error);
+    mtime = time.time_since_epoch().count();
+    return !error;
+}
@@ -0,0 +1,38 @@
+#ifndef FRAMEINDEX_HPP
+#define FRAMEINDEX_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace mol::internal {
+
+// Byte offsets and times of the frames in a trajectory file. Indices
+// can be stored next to the trajectory and are only reused while the
+// trajectory's size and modification time are unchanged.
+class FrameIndex
+{
+public:
+    FrameIndex();
+    size_t size() const;
+    // Frame boundaries: offset(size()) is the end of the last frame
+    uint64_t offset(size_t const frame) const;
+    uint64_t frame_size(size_t const frame) const;
+    // In picoseconds
+    double time(size_t const frame) const;
+    void add_frame(uint64_t const offset, uint64_t const size, double const time = 0);
+    void clear();
+    bool load(std::string const& file_name);
+    bool save(std::string const& file_name) const;
+    static std::string sidecar(std::string const& file_name);
+
+private:
+    static bool file_stamp(std::string const& file_name, uint64_t& size, int64_t& mtime);
+
+    std::vector<uint64_t> m_offsets;
+    std::vector<double> m_times;
+};
+
+} // namespace mol::internal
+
+#endif // FRAMEINDEX_HPP
@@ -0,0 +1,337 @@
+#include "GROReader.hpp"
+#include "MappedFile.hpp"
+#include "ResidueDetect.hpp"
+#include "text.hpp"
+#include "core/MolData.hpp"
+#include <molpp/MolError.hpp>
+
+using namespace mol::internal;
+
+namespace {
+
+// Coordinates start after the residue, name and number columns
+size_t const COORDS_BEGIN = 20;
+// Width of coordinates written with the default precision
+size_t const DEFAULT_WIDTH = 8;
+
+bool is_line(std::string_view const)
+{
+    return true;
+}
+
+} // namespace
+
+GROReader::GROReader()
+: m_num_atoms { 0 },
+  m_width { DEFAULT_WIDTH },
+  m_indexed { 0 },
+  m_current { 0 }
+{}
+
+GROReader::~GROReader()
+{
+    close();
+}
+
+bool GROReader::can_read(std::string const &file_ext)
+{
+    return file_ext == ".gro" && MappedFile::supported();
+}
+
+bool GROReader::has_topology() const
+{
+    return true;
+}
+
+bool GROReader::has_trajectory() const
+{
+    return true;
+}
+
+bool GROReader::has_bonds() const
+{
+    return false;
+}
+
+bool GROReader::has_trajectory_metadata() const
+{
+    return false;
+}
+
+bool GROReader::can_seek() const
+{
+    return true;
+}
+
+MolReader::Status GROReader::open(const std::string &file_name)
+{
+    if (m_file)
+    {
+        return INVALID;
+    }
+
+    m_file = std::make_shared<MappedFile>();
+    if (!m_file->open(file_name))
+    {
+        close();
+        return FAILED;
+    }
+
+    // The first frame tells the number of atoms
+    Frame frame;
+    if (!scan_frame(0, m_num_atoms, frame) || m_num_atoms == 0)
+    {
+        close();
+        return FAILED;
+    }
+    m_frames = {frame};
+    m_indexed = frame.end;
+    m_current = 0;
+
+    // Precision is given by the distance between decimal points
+    char const *pos = chars() + frame.atoms;
+    std::string_view const line = text::next_line(pos, chars() + frame.box);
+    size_t const first = line.find('.', COORDS_BEGIN);
+    size_t const second = (first == std::string_view::npos) ? first : line.find('.', first + 1);
+    m_width = (second == std::string_view::npos) ? DEFAULT_WIDTH : second - first;
+    m_read_ahead.map(m_file->data(), m_file->size());
+
+    return SUCCESS;
+}
+
+void GROReader::close()
+{
+    m_file.reset();
+    m_read_ahead.close();
+    m_frames.clear();
+    m_num_atoms = 0;
+    m_width = DEFAULT_WIDTH;
+    m_indexed = 0;
+    m_current = 0;
+}
+
+std::unique_ptr<MolData> GROReader::read_atoms()
+{
+    if (!m_file)
+    {
+        throw mol::MolError("No opened file");
+    }
+
+    std::unique_ptr<MolData> mol_data = std::make_unique<MolData>(m_num_atoms);
+    AtomData &atoms = mol_data->atoms();
+    Frame const frame = m_frames[0];
+
+    std::vector<int> resids(m_num_atoms);
+    std::vector<std::string_view> resnames(m_num_atoms);
+    {
+        StatsTimer timer(m_stats.decode_time);
+        text::parse_lines(chars() + frame.atoms, chars() + frame.box, m_num_atoms, is_line, [&](std::string_view const line, size_t const i)
+        {
+            resids[i] = text::to_int(text::field(line, 0, 5));
+            resnames[i] = text::trim(text::field(line, 5, 5));
+            atoms.name(i) = text::trim(text::field(line, 10, 5));
+            atoms.type(i) = atoms.name(i);
+        });
+    }
+    m_stats.bytes_read += frame.box - frame.atoms;
+
+    ResidueDetect residues;
+    for (index_t i = 0; i < m_num_atoms; ++i)
+    {
+        atoms.residue(i) = residues.register_atom(resids[i], resnames[i], "", "");
+    }
+    residues.update_residue_data(*mol_data);
+
+    return mol_data;
+}
+
+MolReader::Status GROReader::check_timestep_read(MolData& atom_data)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (atom_data.size() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    return SUCCESS;
+}
+
+MolReader::Status GROReader::skip_timestep()
+{
+    return seek_timestep(m_current + 1);
+}
+
+MolReader::Status GROReader::seek_timestep(size_t const frame)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    index_frames(frame);
+    if (frame > m_frames.size())
+    {
+        m_current = m_frames.size();
+        return END;
+    }
+
+    count_skipped(m_current, frame);
+    m_current = frame;
+    return SUCCESS;
+}
+
+MolReader::Status GROReader::read_timestep(Timestep& timestep)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (timestep.coords().cols() == 0 || timestep.is_view())
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if ((size_t)timestep.coords().cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    index_frames(m_current);
+    if (m_current >= m_frames.size())
+    {
+        return END;
+    }
+
+    Frame const frame = m_frames[m_current];
+    m_read_ahead.access(frame.begin, frame.end - frame.begin);
+    {
+        StatsTimer timer(m_stats.decode_time);
+
+        // The title may tell the time
+        timestep.time() = title_time(frame);
+
+        // Coordinates are in nanometers
+        position_t *coords = timestep.coords().data();
+        size_t const width = m_width;
+        text::parse_lines(chars() + frame.atoms, chars() + frame.box, m_num_atoms, is_line, [coords, width](std::string_view const line, size_t const i)
+        {
+            coords[3 * i] = 10 * text::to_float(text::field(line, COORDS_BEGIN, width));
+            coords[3 * i + 1] = 10 * text::to_float(text::field(line, COORDS_BEGIN + width, width));
+            coords[3 * i + 2] = 10 * text::to_float(text::field(line, COORDS_BEGIN + 2 * width, width));
+        });
+
+        // The box line gives v1(x) v2(y) v3(z), and then
+        // v1(y) v1(z) v2(x) v2(z) v3(x) v3(y) for triclinic boxes
+        char const *pos = chars() + frame.box;
+        std::string_view line = text::next_line(pos, chars() + frame.end);
+        int const rows[] = {0, 1, 2, 1, 2, 0, 2, 0, 1};
+        int const cols[] = {0, 1, 2, 0, 0, 1, 1, 2, 2};
+        Box3 box = Box3::Zero();
+        for (size_t i = 0; i < 9; ++i)
+        {
+            line = text::trim(line);
+            if (line.empty())
+            {
+                break;
+            }
+
+            size_t const space = line.find_first_of(" \t");
+            box(rows[i], cols[i]) = text::to_float(line.substr(0, space));
+            line = (space == std::string_view::npos) ? std::string_view() : line.substr(space);
+        }
+        timestep.cell() = UnitCell::from_vectors(box * 10);
+    }
+
+    m_stats.bytes_read += frame.end - frame.begin;
+    ++m_stats.frames_decoded;
+    ++m_current;
+    return SUCCESS;
+}
+
+bool GROReader::frame_time(size_t const frame, double &time)
+{
+    if (!m_file)
+    {
+        return false;
+    }
+
+    index_frames(frame);
+    if (frame >= m_frames.size())
+    {
+        return false;
+    }
+
+    time = title_time(m_frames[frame]);
+    return true;
+}
+
+char const *GROReader::chars() const
+{
+    return reinterpret_cast<char const *>(m_file->data());
+}
+
+double GROReader::title_time(Frame const& frame) const
+{
+    char const *pos = chars() + frame.begin;
+    std::string_view const title = text::next_line(pos, chars() + frame.atoms);
+    size_t const time = title.find("t=");
+    return (time == std::string_view::npos) ? 0 : text::to_float(title.substr(time + 2));
+}
+
+bool GROReader::scan_frame(size_t const begin, size_t &num_atoms, Frame &frame) const
+{
+    char const *pos = chars() + begin;
+    char const *const end = chars() + m_file->size();
+    frame.begin = begin;
+
+    text::next_line(pos, end);
+    if (pos >= end)
+    {
+        return false;
+    }
+    num_atoms = text::to_int(text::next_line(pos, end));
+
+    frame.atoms = pos - chars();
+    for (size_t i = 0; i < num_atoms; ++i)
+    {
+        if (pos >= end)
+        {
+            return false;
+        }
+        text::next_line(pos, end);
+    }
+
+    frame.box = pos - chars();
+    if (pos >= end)
+    {
+        return false;
+    }
+    text::next_line(pos, end);
+    frame.end = pos - chars();
+
+    return true;
+}
+
+void GROReader::index_frames(size_t const frame)
+{
+    size_t const file_size = m_file->size();
+    while (m_frames.size() <= frame && m_indexed < file_size)
+    {
+        // Truncated frames and frames with other atoms end the
+        // trajectory
+        size_t num_atoms = 0;
+        Frame next;
+        if (!scan_frame(m_indexed, num_atoms, next) || num_atoms != m_num_atoms)
+        {
+            m_indexed = file_size;
+            break;
+        }
+
+        m_frames.push_back(next);
+        m_indexed = next.end;
+    }
+}
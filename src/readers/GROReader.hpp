@@ -0,0 +1,72 @@
+#ifndef GROREADER_HPP
+#define GROREADER_HPP
+
+#include "MolReader.hpp"
+#include "ReadAhead.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace mol::internal {
+
+class MappedFile;
+
+// Native reader for Gromacs' GRO files. The file is memory-mapped and
+// the atom lines of large frames are parsed in parallel, each thread
+// filling its own range of atom columns. Frames are indexed as they
+// are reached, so seeking back is O(1).
+class GROReader : public MolReader
+{
+public:
+    GROReader();
+    ~GROReader();
+    static bool can_read(std::string const &file_ext);
+    bool has_topology() const override;
+    bool has_trajectory() const override;
+    bool has_bonds() const override;
+    bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
+    Status open(const std::string &file_name) override;
+    void close() override;
+    std::unique_ptr<MolData> read_atoms() override;
+    Status check_timestep_read(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    bool frame_time(size_t const frame, double &time) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
+
+private:
+    // Offsets of the title, atom and box lines of a frame, and of its end
+    struct Frame
+    {
+        size_t begin;
+        size_t atoms;
+        size_t box;
+        size_t end;
+    };
+
+    char const *chars() const;
+    // Time told by the title of a frame, or zero
+    double title_time(Frame const& frame) const;
+    // Frame starting at the given offset and its number of atoms.
+    // Returns false if the frame is truncated.
+    bool scan_frame(size_t const begin, size_t &num_atoms, Frame &frame) const;
+    // Indexes frames until the given one is known or the file ends
+    void index_frames(size_t const frame);
+
+    std::shared_ptr<MappedFile> m_file;
+    ReadAhead m_read_ahead;
+    size_t m_num_atoms;
+    // Width of coordinates, which tells their precision
+    size_t m_width;
+    std::vector<Frame> m_frames;
+    // Offset frames are indexed from
+    size_t m_indexed;
+    size_t m_current;
+};
+
+} // namespace mol::internal
+
+#endif // GROREADER_HPP
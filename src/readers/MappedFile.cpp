@@ -0,0 +1,92 @@
+#include "MappedFile.hpp"
+
+#if __has_include(<sys/mman.h>)
+#define MOLPP_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace mol::internal;
+
+MappedFile::MappedFile()
+: m_data{nullptr},
+  m_size{0}
+{}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::supported()
+{
+#ifdef MOLPP_HAS_MMAP
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool MappedFile::open(std::string const& file_name)
+{
+    close();
+
+#ifdef MOLPP_HAS_MMAP
+    int const fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping remains valid after closing the descriptor
+    void *data = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_data = static_cast<unsigned char *>(data);
+    m_size = status.st_size;
+    return true;
+#else
+    (void)file_name;
+    return false;
+#endif
+}
+
+void MappedFile::close()
+{
+#ifdef MOLPP_HAS_MMAP
+    if (m_data)
+    {
+        munmap(m_data, m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::is_open() const
+{
+    return m_data != nullptr;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+unsigned char *MappedFile::data() const
+{
+    return m_data;
+}
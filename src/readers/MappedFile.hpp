@@ -0,0 +1,32 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace mol::internal {
+
+// Private, copy-on-write memory mapping of a whole file. Pages are
+// shared with the page cache (and other processes) until written.
+class MappedFile
+{
+public:
+    MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile();
+    static bool supported();
+    bool open(std::string const& file_name);
+    void close();
+    bool is_open() const;
+    size_t size() const;
+    unsigned char *data() const;
+
+private:
+    unsigned char *m_data;
+    size_t m_size;
+};
+
+} // namespace mol::internal
+
+#endif // MAPPEDFILE_HPP
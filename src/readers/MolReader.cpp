@@ -1,11 +1,86 @@
 #include "MolReader.hpp"
 #include "MolfileReader.hpp"
+#include "XTCReader.hpp"
+#include "TRRReader.hpp"
+#include "DCDReader.hpp"
+#include "BINPOSReader.hpp"
+#include "PDBReader.hpp"
+#include "GROReader.hpp"
+#include "SnapshotReader.hpp"
+#include "TimestepRing.hpp"
 #include "core/MolData.hpp"
+#include "core/TimestepPool.hpp"
+#include <thread>
+#include <exception>
+#include <cmath>
+#include <algorithm>
 
 using namespace mol::internal;
 
+namespace {
+
+// Times are often stored in single precision
+double time_tolerance(double const time)
+{
+    return 1e-6 * std::max(1.0, std::abs(time));
+}
+
+// Closes the reader when leaving the scope, exceptions included
+class CloseGuard
+{
+public:
+    CloseGuard(MolReader &reader)
+    : m_reader { reader }
+    {}
+
+    ~CloseGuard()
+    {
+        m_reader.close();
+    }
+
+private:
+    MolReader &m_reader;
+};
+
+} // namespace
+
 std::shared_ptr<MolReader> MolReader::from_file_ext(const std::string &file_ext)
 {
+    if (XTCReader::can_read(file_ext))
+    {
+        return std::make_shared<XTCReader>();
+    }
+
+    if (TRRReader::can_read(file_ext))
+    {
+        return std::make_shared<TRRReader>();
+    }
+
+    if (DCDReader::can_read(file_ext))
+    {
+        return std::make_shared<DCDReader>();
+    }
+
+    if (BINPOSReader::can_read(file_ext))
+    {
+        return std::make_shared<BINPOSReader>();
+    }
+
+    if (PDBReader::can_read(file_ext))
+    {
+        return std::make_shared<PDBReader>();
+    }
+
+    if (GROReader::can_read(file_ext))
+    {
+        return std::make_shared<GROReader>();
+    }
+
+    if (SnapshotReader::can_read(file_ext))
+    {
+        return std::make_shared<SnapshotReader>();
+    }
+
     if (MolfileReader::can_read(file_ext))
     {
         return std::make_shared<MolfileReader>(file_ext);
@@ -21,12 +96,46 @@ std::unique_ptr<MolData> MolReader::read_topology(std::string const &file_name)
         return nullptr;
     }
 
-    std::unique_ptr<MolData> mol_data = read_atoms();
-    close();
-    return mol_data;
+    CloseGuard const guard(*this);
+    return read_atoms();
+}
+
+MolReader::Status MolReader::skip_timestep(MolData& atom_data)
+{
+    Status const status = check_timestep_read(atom_data);
+    return (status == SUCCESS) ? skip_timestep() : status;
+}
+
+MolReader::Status MolReader::read_timestep(MolData& atom_data)
+{
+    Timestep ts = atom_data.trajectory().pool().acquire(atom_data.size());
+    Status const status = read_timestep(ts);
+    if (status == SUCCESS)
+    {
+        atom_data.trajectory().add_timestep(std::move(ts));
+    }
+    return status;
 }
 
 MolReader::Status MolReader::read_trajectory(std::string const &file_name, MolData& atom_data, int begin, int end, int step)
+{
+    return stream_trajectory(file_name, atom_data, [&atom_data](size_t const, Timestep &ts)
+    {
+        atom_data.trajectory().add_timestep(std::move(ts));
+        return true;
+    }, begin, end, step, 0, &atom_data.trajectory().pool());
+}
+
+MolReader::Status MolReader::read_trajectory_times(std::string const &file_name, MolData& atom_data, double begin, double end, double step)
+{
+    return stream_trajectory_times(file_name, atom_data, [&atom_data](size_t const, Timestep &ts)
+    {
+        atom_data.trajectory().add_timestep(std::move(ts));
+        return true;
+    }, begin, end, step, &atom_data.trajectory().pool());
+}
+
+MolReader::Status MolReader::stream_trajectory(std::string const &file_name, MolData& atom_data, TimestepCallback const& callback, int begin, int end, int step, size_t prefetch, TimestepPool *pool)
 {
     // Sanity checks
     if (!has_trajectory())
@@ -40,47 +149,381 @@ MolReader::Status MolReader::read_trajectory(std::string const &file_name, MolDa
         return status;
     }
 
+    CloseGuard const guard(*this);
     status = check_timestep_read(atom_data);
     if (status != SUCCESS)
     {
-        close();
         return status;
     }
 
-    // Initial skip
     begin = (begin < 0) ? 0 : begin;
     step = (step < 1) ? 1 : step;
-    int current;
-    for (current = 0; current < begin; ++current)
+    if (prefetch)
     {
-        status = skip_timestep(atom_data);
-        if (status != SUCCESS)
+        status = prefetch_frames(callback, begin, end, step, prefetch, atom_data.size(), pool);
+    }
+    else
+    {
+        status = read_frames(callback, begin, end, step, atom_data.size(), pool);
+    }
+
+    return (status == END) ? SUCCESS : status;
+}
+
+MolReader::Status MolReader::stream_trajectory_times(std::string const &file_name, MolData& atom_data, TimestepCallback const& callback, double begin, double end, double step, TimestepPool *pool)
+{
+    // Sanity checks
+    if (!has_trajectory() || step < 0)
+    {
+        return INVALID;
+    }
+
+    Status status = open(file_name);
+    if (status != SUCCESS)
+    {
+        return status;
+    }
+
+    CloseGuard const guard(*this);
+    status = check_timestep_read(atom_data);
+    if (status != SUCCESS)
+    {
+        return status;
+    }
+
+    double time = 0;
+    if (!can_seek() || !frame_time(0, time))
+    {
+        status = filter_times(callback, begin, end, step, atom_data.size(), pool);
+        return (status == END) ? SUCCESS : status;
+    }
+
+    // Frames are found by their headers, then read
+    std::vector<size_t> frames;
+    size_t frame = 0;
+    double target = begin;
+    while (find_time(target, frame) && frame_time(frame, time) && time <= end + time_tolerance(end))
+    {
+        frames.push_back(frame);
+        if (step == 0)
         {
-            close();
-            return (status == END) ? SUCCESS : status;
+            ++frame;
+            continue;
         }
+
+        // Times the frame was the first at or after
+        double const count = std::floor((time - begin + time_tolerance(time)) / step) + 1;
+        target = begin + std::max(count, 1.0) * step;
+    }
+
+    status = read_selected(frames, callback, atom_data.size(), pool);
+    return (status == END) ? SUCCESS : status;
+}
+
+MolReader::Status MolReader::read_frames(TimestepCallback const& callback, int const begin, int const end, int const step, size_t const num_atoms, TimestepPool *pool)
+{
+    if (can_seek() && batch_size() > 1)
+    {
+        return read_batches(callback, begin, end, step, num_atoms, pool);
     }
 
-    // Read frames
-    status = SUCCESS;
-    while (end < 0 || current++ < end)
+    // The same timestep is reused unless the callback takes it
+    // away, in which case a recycled one is used, if any.
+    Timestep ts;
+    Status status = skip_timesteps(0, begin);
+    for (int current = begin; status == SUCCESS && (end < 0 || current < end); current += step)
     {
-        status = read_timestep(atom_data);
-        if (status != SUCCESS)
+        if (pool && ts.coords().cols() == 0)
+        {
+            ts = pool->acquire(num_atoms);
+        }
+
+        status = read_timestep(ts);
+        if (status != SUCCESS || !callback(current, ts))
         {
             break;
         }
 
-        for (int i = 1; i < step; ++i, ++current)
+        status = skip_timesteps(current + 1, step - 1);
+    }
+
+    if (pool)
+    {
+        pool->release(std::move(ts));
+    }
+    return status;
+}
+
+MolReader::Status MolReader::read_batches(TimestepCallback const& callback, int const begin, int const end, int const step, size_t const num_atoms, TimestepPool *pool)
+{
+    size_t const batch = batch_size();
+    std::vector<size_t> frames;
+    std::vector<Timestep> timesteps(batch);
+    Status status = SUCCESS;
+    bool more = true;
+
+    for (int current = begin; more && status == SUCCESS && (end < 0 || current < end);)
+    {
+        frames.clear();
+        for (; frames.size() < batch && (end < 0 || current < end); current += step)
+        {
+            frames.push_back(current);
+        }
+
+        for (size_t i = 0; pool && i < frames.size(); ++i)
+        {
+            if (timesteps[i].coords().cols() == 0)
+            {
+                timesteps[i] = pool->acquire(num_atoms);
+            }
+        }
+
+        size_t num_read = 0;
+        status = read_timesteps(frames, timesteps, num_read);
+        for (size_t i = 0; more && i < num_read; ++i)
+        {
+            more = callback(frames[i], timesteps[i]);
+        }
+        if (status == SUCCESS && num_read < frames.size())
+        {
+            status = END;
+        }
+    }
+
+    for (size_t i = 0; pool && i < timesteps.size(); ++i)
+    {
+        pool->release(std::move(timesteps[i]));
+    }
+    return status;
+}
+
+MolReader::Status MolReader::prefetch_frames(TimestepCallback const& callback, int const begin, int const end, int const step, size_t const depth, size_t const num_atoms, TimestepPool *pool)
+{
+    // Frames are decoded ahead on a background thread. Consumed
+    // buffers are swapped back to the producer for reuse.
+    TimestepRing ring(depth);
+    Status status = SUCCESS;
+    // Exceptions of the producer are thrown again by the consumer
+    std::exception_ptr error;
+    std::thread producer([&]()
+    {
+        try
+        {
+            status = read_frames([&ring](size_t const frame, Timestep &ts)
+            {
+                Timestep *slot = ring.acquire();
+                if (!slot)
+                {
+                    return false;
+                }
+                slot->swap(ts);
+                ring.publish(frame);
+                return true;
+            }, begin, end, step, num_atoms, pool);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        ring.close();
+    });
+
+    try
+    {
+        size_t frame = 0;
+        while (Timestep *ts = ring.front(frame))
         {
-            status = skip_timestep(atom_data);
-            if (status != SUCCESS)
+            bool const more = callback(frame, *ts);
+            ring.pop();
+            if (!more)
             {
                 break;
             }
         }
     }
+    catch (...)
+    {
+        ring.close();
+        producer.join();
+        throw;
+    }
 
-    close();
-    return (status == END) ? SUCCESS : status;
+    ring.close();
+    producer.join();
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    // Frames waiting in the ring are held on top of the reader's buffers
+    track_buffer(m_stats.peak_buffer_bytes + depth * 3 * num_atoms * sizeof(position_t));
+    return status;
+}
+
+size_t MolReader::batch_size() const
+{
+    return 1;
+}
+
+MolReader::Status MolReader::read_timesteps(std::vector<size_t> const& frames, std::vector<Timestep>& timesteps, size_t &num_read)
+{
+    num_read = 0;
+    for (size_t const frame : frames)
+    {
+        Status status = seek_timestep(frame);
+        if (status == SUCCESS)
+        {
+            status = read_timestep(timesteps[num_read]);
+        }
+
+        if (status != SUCCESS)
+        {
+            return status;
+        }
+        ++num_read;
+    }
+
+    return SUCCESS;
+}
+
+bool MolReader::frame_time(size_t const, double &)
+{
+    return false;
+}
+
+void MolReader::reset_stats()
+{
+    m_stats = ReaderStats();
+}
+
+void MolReader::count_skipped(size_t const current, size_t const frame)
+{
+    if (frame > current)
+    {
+        m_stats.frames_skipped += frame - current;
+    }
+}
+
+void MolReader::track_buffer(size_t const bytes)
+{
+    m_stats.peak_buffer_bytes = std::max(m_stats.peak_buffer_bytes, bytes);
+}
+
+MolReader::Status MolReader::read_selected(std::vector<size_t> const& frames, TimestepCallback const& callback, size_t const num_atoms, TimestepPool *pool)
+{
+    size_t const batch = batch_size();
+    std::vector<size_t> batch_frames;
+    std::vector<Timestep> timesteps(batch);
+    Status status = SUCCESS;
+    bool more = true;
+
+    for (size_t first = 0; more && status == SUCCESS && first < frames.size(); first += batch)
+    {
+        batch_frames.assign(frames.begin() + first, frames.begin() + std::min(first + batch, frames.size()));
+        for (size_t i = 0; pool && i < batch_frames.size(); ++i)
+        {
+            if (timesteps[i].coords().cols() == 0)
+            {
+                timesteps[i] = pool->acquire(num_atoms);
+            }
+        }
+
+        size_t num_read = 0;
+        status = read_timesteps(batch_frames, timesteps, num_read);
+        for (size_t i = 0; more && i < num_read; ++i)
+        {
+            more = callback(batch_frames[i], timesteps[i]);
+        }
+    }
+
+    for (size_t i = 0; pool && i < timesteps.size(); ++i)
+    {
+        pool->release(std::move(timesteps[i]));
+    }
+    return status;
+}
+
+MolReader::Status MolReader::filter_times(TimestepCallback const& callback, double const begin, double const end, double const step, size_t const num_atoms, TimestepPool *pool)
+{
+    // Everything is decoded, but only the selected frames are kept
+    double target = begin;
+    return read_frames([&](size_t const frame, Timestep &ts)
+    {
+        double const time = ts.time();
+        if (time > end + time_tolerance(end))
+        {
+            return false;
+        }
+        if (time < target - time_tolerance(target))
+        {
+            return true;
+        }
+
+        if (step > 0)
+        {
+            double const count = std::floor((time - begin + time_tolerance(time)) / step) + 1;
+            target = begin + std::max(count, 1.0) * step;
+        }
+        return callback(frame, ts);
+    }, 0, -1, 1, num_atoms, pool);
+}
+
+bool MolReader::find_time(double const time, size_t &frame)
+{
+    // Frames before time are in [low, high[ while galloping ahead
+    double current = 0;
+    if (!frame_time(frame, current))
+    {
+        return false;
+    }
+    if (current >= time - time_tolerance(time))
+    {
+        return true;
+    }
+
+    size_t low = frame;
+    size_t high = frame + 1;
+    size_t stride = 1;
+    while (frame_time(high, current) && current < time - time_tolerance(time))
+    {
+        low = high;
+        stride *= 2;
+        high = low + stride;
+    }
+
+    // First frame past the end or at the time within ]low, high]
+    while (high - low > 1)
+    {
+        size_t const middle = low + (high - low) / 2;
+        if (!frame_time(middle, current) || current >= time - time_tolerance(time))
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle;
+        }
+    }
+
+    frame = high;
+    return frame_time(frame, current);
+}
+
+MolReader::Status MolReader::skip_timesteps(size_t const current, size_t const count)
+{
+    if (can_seek())
+    {
+        return seek_timestep(current + count);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Status const status = skip_timestep();
+        if (status != SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    return SUCCESS;
 }
@@ -1,14 +1,37 @@
 #ifndef MOLREADER_HPP
 #define MOLREADER_HPP
 
+#include <molpp/Timestep.hpp>
+#include <molpp/ReaderStats.hpp>
 #include <string>
 #include <memory>
 #include <vector>
+#include <chrono>
 
 namespace mol::internal
 {
 
 class MolData;
+class TimestepPool;
+
+// Adds the time spent in its scope to a counter
+class StatsTimer
+{
+public:
+    StatsTimer(double &seconds)
+    : m_seconds { seconds },
+      m_start { std::chrono::steady_clock::now() }
+    {}
+
+    ~StatsTimer()
+    {
+        m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    double &m_seconds;
+    std::chrono::steady_clock::time_point m_start;
+};
 
 class MolReader
 {
@@ -26,18 +49,62 @@ public:
     virtual ~MolReader() {};
     std::unique_ptr<MolData> read_topology(std::string const &file_name);
     Status read_trajectory(std::string const& file_name, MolData& atom_data, int begin=0, int end=-1, int step=1);
+    // Reads frames one by one without storing them in the trajectory.
+    // Up to prefetch frames are decoded ahead on a background thread.
+    // Timesteps taken away by the callback are replaced from the pool.
+    Status stream_trajectory(std::string const& file_name, MolData& atom_data, TimestepCallback const& callback, int begin=0, int end=-1, int step=1, size_t prefetch=0, TimestepPool *pool=nullptr);
+    // Frames from the begin to the end time, in picoseconds, one per
+    // time step. Each time selects the first frame at or after it and
+    // a zero step selects all frames. Readers able to tell frame times
+    // without decoding seek straight to the frames selected.
+    Status read_trajectory_times(std::string const& file_name, MolData& atom_data, double begin, double end, double step=0);
+    Status stream_trajectory_times(std::string const& file_name, MolData& atom_data, TimestepCallback const& callback, double begin, double end, double step=0, TimestepPool *pool=nullptr);
     virtual bool has_topology() const = 0;
     virtual bool has_trajectory() const = 0;
     virtual bool has_bonds() const = 0;
     virtual bool has_trajectory_metadata() const = 0;
+    virtual bool can_seek() const = 0;
     virtual Status open(const std::string &file_name) = 0;
     virtual void close() = 0;
     virtual std::unique_ptr<MolData> read_atoms() = 0;
     virtual Status check_timestep_read(MolData& atom_data) = 0;
-    virtual Status skip_timestep(MolData& atom_data) = 0;
-    virtual Status read_timestep(MolData& atom_data) = 0;
+    Status skip_timestep(MolData& atom_data);
+    virtual Status skip_timestep() = 0;
+    virtual Status seek_timestep(size_t const frame) = 0;
+    Status read_timestep(MolData& atom_data);
+    // Empty timesteps and views are (re)allocated by the reader, possibly
+    // as views of its own storage. Otherwise, they are filled in place.
+    virtual Status read_timestep(Timestep& timestep) = 0;
+    // Seekable readers able to decode several frames at once (e.g. in
+    // parallel) read batches of this size. Frames must be ascending
+    // and num_read tells how many were read before the end.
+    virtual size_t batch_size() const;
+    virtual Status read_timesteps(std::vector<size_t> const& frames, std::vector<Timestep>& timesteps, size_t &num_read);
+    // Time of a frame of the opened file, without decoding it nor moving
+    // to it. Returns false past the end or if times are unknown.
+    virtual bool frame_time(size_t const frame, double &time);
+    // Counters kept since the reader was created or reset, over all
+    // the files opened
+    ReaderStats const& stats() const { return m_stats; }
+    void reset_stats();
+
+protected:
+    // Frames jumped over when moving from the current frame
+    void count_skipped(size_t const current, size_t const frame);
+    void track_buffer(size_t const bytes);
+
+    ReaderStats m_stats;
 
 private:
+    Status read_frames(TimestepCallback const& callback, int const begin, int const end, int const step, size_t const num_atoms, TimestepPool *pool);
+    Status read_batches(TimestepCallback const& callback, int const begin, int const end, int const step, size_t const num_atoms, TimestepPool *pool);
+    Status prefetch_frames(TimestepCallback const& callback, int const begin, int const end, int const step, size_t const depth, size_t const num_atoms, TimestepPool *pool);
+    Status skip_timesteps(size_t const current, size_t const count);
+    Status read_selected(std::vector<size_t> const& frames, TimestepCallback const& callback, size_t const num_atoms, TimestepPool *pool);
+    Status filter_times(TimestepCallback const& callback, double const begin, double const end, double const step, size_t const num_atoms, TimestepPool *pool);
+    // First frame from the given one with a time at or after the given
+    // time. Returns false if there is none.
+    bool find_time(double const time, size_t &frame);
 };
 
 } // namespace mol::internal
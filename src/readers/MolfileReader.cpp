@@ -2,7 +2,6 @@
 #include "MolfileReader.hpp"
 #include "core/MolData.hpp"
 #include "ResidueDetect.hpp"
-#include <molpp/Atom.hpp>
 #include <molpp/Residue.hpp>
 #include <molpp/MolError.hpp>
 #include <map>
@@ -44,6 +43,8 @@ private:
         if (mol2plugin_init() == VMDPLUGIN_SUCCESS) mol2plugin_register(this, register_cb);
         if (psfplugin_init() == VMDPLUGIN_SUCCESS) psfplugin_register(this, register_cb);
         if (gromacsplugin_init() == VMDPLUGIN_SUCCESS) gromacsplugin_register(this, register_cb);
+        if (dcdplugin_init() == VMDPLUGIN_SUCCESS) dcdplugin_register(this, register_cb);
+        if (binposplugin_init() == VMDPLUGIN_SUCCESS) binposplugin_register(this, register_cb);
 
         // Register extensions
         std::regex regexz(",");
@@ -110,6 +111,11 @@ bool MolfileReader::has_trajectory_metadata() const
     return m_plugin->read_timestep_metadata != nullptr;
 }
 
+bool MolfileReader::can_seek() const
+{
+    return false;
+}
+
 bool MolfileReader::has_trajectory() const
 {
     return m_plugin->read_next_timestep != nullptr;
@@ -127,11 +133,17 @@ MolReader::Status MolfileReader::open(const std::string &file_name)
         return MolReader::INVALID;
     }
 
+    auto const lock = lock_plugin();
     m_handle = m_plugin->open_file_read(file_name.c_str(), m_name.c_str(), &m_num_atoms);
 
     if (!m_handle || m_num_atoms <= 0)
     {
-        close();
+        if (m_handle)
+        {
+            m_plugin->close_file_read(m_handle);
+        }
+        m_handle = nullptr;
+        m_num_atoms = 0;
         return MolReader::FAILED;
     }
 
@@ -142,6 +154,7 @@ void MolfileReader::close()
 {
     if (m_handle)
     {
+        auto const lock = lock_plugin();
         m_plugin->close_file_read(m_handle);
     }
     m_handle = nullptr;
@@ -156,6 +169,7 @@ std::unique_ptr<MolData> MolfileReader::read_atoms()
     }
 
     // Read data and allocate atoms
+    auto const lock = lock_plugin();
     std::vector<molfile_atom_t> molfile_atoms(m_num_atoms);
     int flags = MOLFILE_BADOPTIONS;
     if (m_plugin->read_structure(m_handle, &flags, molfile_atoms.data()) != MOLFILE_SUCCESS || flags == (int)MOLFILE_BADOPTIONS)
@@ -164,59 +178,55 @@ std::unique_ptr<MolData> MolfileReader::read_atoms()
     }
 
     std::unique_ptr<MolData> mol_data = std::make_unique<MolData>(m_num_atoms);
-    ResidueDetect residues;
-
-    // Loop over all atoms
-    for (index_t i = 0; i < (size_t)m_num_atoms; ++i)
-    {
-        /*
-         * Atoms properties
-         */
-        molfile_atom_t const &mol_atom = molfile_atoms[i];
 
-        Atom atom(i, {}, mol_data.get());
-        atom.set_name(mol_atom.name);
-        atom.set_type(mol_atom.type);
+    // Atoms properties, column by column. Optional ones are left
+    // zeroed unless the plugin gives them.
+    AtomData &atoms = mol_data->atoms();
+    atoms.fill_names(molfile_atoms, &molfile_atom_t::name);
+    atoms.fill_types(molfile_atoms, &molfile_atom_t::type);
 
-        if (flags & MOLFILE_INSERTION)
-        {
-            atom.set_altloc(mol_atom.altloc);
-        }
-
-        if (flags & MOLFILE_OCCUPANCY)
-        {
-            atom.set_occupancy(mol_atom.occupancy);
-        }
+    if (flags & MOLFILE_INSERTION)
+    {
+        atoms.fill_altlocs(molfile_atoms, &molfile_atom_t::altloc);
+    }
 
-        if (flags & MOLFILE_BFACTOR)
-        {
-            atom.set_tempfactor(mol_atom.bfactor);
-        }
+    if (flags & MOLFILE_OCCUPANCY)
+    {
+        atoms.fill_occupancies(molfile_atoms, &molfile_atom_t::occupancy);
+    }
 
-        if (flags & MOLFILE_MASS)
-        {
-            atom.set_mass(mol_atom.mass);
-        }
+    if (flags & MOLFILE_BFACTOR)
+    {
+        atoms.fill_tempfactors(molfile_atoms, &molfile_atom_t::bfactor);
+    }
 
-        if (flags & MOLFILE_CHARGE)
-        {
-            atom.set_charge(mol_atom.charge);
-        }
+    if (flags & MOLFILE_MASS)
+    {
+        atoms.fill_masses(molfile_atoms, &molfile_atom_t::mass);
+    }
 
-        if (flags & MOLFILE_RADIUS)
-        {
-            atom.set_radius(mol_atom.radius);
-        }
+    if (flags & MOLFILE_CHARGE)
+    {
+        atoms.fill_charges(molfile_atoms, &molfile_atom_t::charge);
+    }
 
-        if (flags & MOLFILE_ATOMICNUMBER)
-        {
-            atom.set_atomic(mol_atom.atomicnumber);
-        }
+    if (flags & MOLFILE_RADIUS)
+    {
+        atoms.fill_radii(molfile_atoms, &molfile_atom_t::radius);
+    }
 
-        // Detect residues
-        mol_data->atoms().residue(i) = residues.register_atom(mol_atom.resid, mol_atom.resname, mol_atom.segid, mol_atom.chain);
+    if (flags & MOLFILE_ATOMICNUMBER)
+    {
+        atoms.fill_atomics(molfile_atoms, &molfile_atom_t::atomicnumber);
     }
 
+    // Detect residues
+    ResidueDetect residues;
+    atoms.fill_residues(molfile_atoms, [&residues](molfile_atom_t const& mol_atom)
+    {
+        return residues.register_atom(mol_atom.resid, mol_atom.resname, mol_atom.segid, mol_atom.chain);
+    });
+
     // Update residues data
     residues.update_residue_data(*mol_data);
 
@@ -283,11 +293,13 @@ MolReader::Status MolfileReader::check_timestep_read(MolData& mol_data)
     return SUCCESS;
 }
 
-MolReader::Status MolfileReader::skip_timestep(MolData& mol_data)
+MolReader::Status MolfileReader::skip_timestep()
 {
-    switch (m_plugin->read_next_timestep(m_handle, mol_data.size(), nullptr))
+    auto const lock = lock_plugin();
+    switch (m_plugin->read_next_timestep(m_handle, m_num_atoms, nullptr))
     {
         case MOLFILE_SUCCESS:
+            ++m_stats.frames_skipped;
             return SUCCESS;
 
         case MOLFILE_EOF:
@@ -298,17 +310,44 @@ MolReader::Status MolfileReader::skip_timestep(MolData& mol_data)
     }
 }
 
-MolReader::Status MolfileReader::read_timestep(MolData& mol_data)
+MolReader::Status MolfileReader::seek_timestep(size_t const)
 {
-    Timestep ts(mol_data.size());
+    // Plugins only read sequentially
+    return INVALID;
+}
+
+MolReader::Status MolfileReader::read_timestep(Timestep& timestep)
+{
+    if (timestep.coords().cols() == 0 || timestep.is_view())
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if (timestep.coords().cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
     molfile_timestep_t mol_ts;
-    mol_ts.coords = ts.coords().data();
+    mol_ts.coords = timestep.coords().data();
     mol_ts.physical_time = 0.0;
+    mol_ts.A = mol_ts.B = mol_ts.C = 0;
+    mol_ts.alpha = mol_ts.beta = mol_ts.gamma = 90;
 
-    switch (m_plugin->read_next_timestep(m_handle, mol_data.size(), &mol_ts))
+    // Plugins read and decode at once, without telling how many
+    // bytes, so all their time counts as decoding
+    auto const lock = lock_plugin();
+    int status;
+    {
+        StatsTimer timer(m_stats.decode_time);
+        status = m_plugin->read_next_timestep(m_handle, m_num_atoms, &mol_ts);
+    }
+    switch (status)
     {
         case MOLFILE_SUCCESS:
-            break;
+            ++m_stats.frames_decoded;
+            timestep.cell() = UnitCell({mol_ts.A, mol_ts.B, mol_ts.C}, {mol_ts.alpha, mol_ts.beta, mol_ts.gamma});
+            timestep.time() = mol_ts.physical_time;
+            return SUCCESS;
 
         case MOLFILE_EOF:
             return END;
@@ -316,8 +355,16 @@ MolReader::Status MolfileReader::read_timestep(MolData& mol_data)
         default:
             return FAILED;
     }
+}
 
-    mol_data.trajectory().add_timestep(std::move(ts));
-
-    return SUCCESS;
+std::unique_lock<std::mutex> MolfileReader::lock_plugin() const
+{
+    // Thread-unsafe plugins may share global state (e.g. all Gromacs
+    // formats do), so calls to any of them are serialized.
+    static std::mutex mutex;
+    if (m_plugin->is_reentrant == VMDPLUGIN_THREADSAFE)
+    {
+        return std::unique_lock<std::mutex>(mutex, std::defer_lock);
+    }
+    return std::unique_lock<std::mutex>(mutex);
 }
@@ -4,6 +4,7 @@
 #include "MolReader.hpp"
 #include "molfile_plugin.h"
 #include <string>
+#include <mutex>
 
 namespace mol::internal {
 
@@ -18,14 +19,20 @@ public:
     bool has_trajectory() const override;
     bool has_bonds() const override;
     bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
     Status open(const std::string &file_name) override;
     void close() override;
     std::unique_ptr<MolData> read_atoms() override;
     Status check_timestep_read(MolData& atom_data) override;
-    Status skip_timestep(MolData& atom_data) override;
-    Status read_timestep(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
 
 private:
+    std::unique_lock<std::mutex> lock_plugin() const;
+
     int m_num_atoms;
     void *m_handle;
     std::string m_name;
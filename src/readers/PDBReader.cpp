@@ -0,0 +1,434 @@
+#include "PDBReader.hpp"
+#include "MappedFile.hpp"
+#include "ResidueDetect.hpp"
+#include "text.hpp"
+#include "core/MolData.hpp"
+#include <molpp/ElementsTable.hpp>
+#include <molpp/MolError.hpp>
+#include <unordered_map>
+#include <atomic>
+#include <cctype>
+
+using namespace mol::internal;
+
+namespace {
+
+// Serial numbers of CONECT records only fit 5 digits
+size_t const MAX_CONECT_ATOMS = 100000;
+// Bonded atoms of a CONECT record, after the first one
+size_t const CONECT_END = 61;
+
+bool is_atom(std::string_view const line)
+{
+    // Only 5 characters of ATOM records are checked, so that files
+    // with over 99,999 atoms can be read
+    return line.starts_with("ATOM ") || line.starts_with("HETATM");
+}
+
+// Atomic number of an element symbol, or zero if unknown
+int element_atomic(std::string_view const symbol)
+{
+    static std::unordered_map<uint16_t, int> const atomics = []()
+    {
+        std::unordered_map<uint16_t, int> table;
+        mol::ElementsTable const& elements = mol::ELEMENTS_TABLE();
+        for (size_t i = 1; i < elements.size(); ++i)
+        {
+            std::string const& name = elements.symbol(i);
+            uint16_t const key = (std::toupper(name[0]) << 8) | (name.size() > 1 ? std::toupper(name[1]) : 0);
+            table[key] = elements.atomic_number(i);
+        }
+        return table;
+    }();
+
+    // Symbols are right-justified
+    std::string_view const letters = text::trim(symbol);
+    if (letters.empty())
+    {
+        return 0;
+    }
+    uint16_t const key = (std::toupper(letters[0]) << 8) | (letters.size() > 1 ? std::toupper(letters[1]) : 0);
+    auto const it = atomics.find(key);
+    return (it == atomics.end()) ? 0 : it->second;
+}
+
+// Unit cell given before the atoms of a model, or the given one. The
+// position is moved to the first atom.
+mol::UnitCell read_cell(char const *&pos, char const *const end, mol::UnitCell const& cell)
+{
+    mol::UnitCell model_cell = cell;
+    for (char const *line_start = pos; pos < end; line_start = pos)
+    {
+        std::string_view const line = text::next_line(pos, end);
+        if (is_atom(line))
+        {
+            pos = line_start;
+            break;
+        }
+
+        if (line.starts_with("CRYST1"))
+        {
+            mol::Point3 const lengths(text::to_float(text::field(line, 6, 9)), text::to_float(text::field(line, 15, 9)), text::to_float(text::field(line, 24, 9)));
+            mol::Point3 const angles(text::to_float(text::field(line, 33, 7)), text::to_float(text::field(line, 40, 7)), text::to_float(text::field(line, 47, 7)));
+            model_cell = mol::UnitCell(lengths, angles);
+        }
+    }
+
+    return model_cell;
+}
+
+} // namespace
+
+PDBReader::PDBReader()
+: m_num_atoms { 0 },
+  m_num_conect { 0 },
+  m_indexed { 0 },
+  m_current { 0 }
+{}
+
+PDBReader::~PDBReader()
+{
+    close();
+}
+
+bool PDBReader::can_read(std::string const &file_ext)
+{
+    return (file_ext == ".pdb" || file_ext == ".ent") && MappedFile::supported();
+}
+
+bool PDBReader::has_topology() const
+{
+    return true;
+}
+
+bool PDBReader::has_trajectory() const
+{
+    return true;
+}
+
+bool PDBReader::has_bonds() const
+{
+    return true;
+}
+
+bool PDBReader::has_trajectory_metadata() const
+{
+    return false;
+}
+
+bool PDBReader::can_seek() const
+{
+    return true;
+}
+
+MolReader::Status PDBReader::open(const std::string &file_name)
+{
+    if (m_file)
+    {
+        return INVALID;
+    }
+
+    m_file = std::make_shared<MappedFile>();
+    if (!m_file->open(file_name))
+    {
+        close();
+        return FAILED;
+    }
+
+    // The first model tells the number of atoms
+    size_t const end = scan_model(0, m_num_atoms, m_num_conect);
+    if (m_num_atoms == 0)
+    {
+        close();
+        return FAILED;
+    }
+    char const *pos = chars();
+    m_cell = read_cell(pos, chars() + end, UnitCell());
+    m_frames = {{0, end}};
+    m_indexed = end;
+    m_current = 0;
+    m_read_ahead.map(m_file->data(), m_file->size());
+
+    return SUCCESS;
+}
+
+void PDBReader::close()
+{
+    m_file.reset();
+    m_read_ahead.close();
+    m_frames.clear();
+    m_num_atoms = 0;
+    m_num_conect = 0;
+    m_cell = UnitCell();
+    m_indexed = 0;
+    m_current = 0;
+}
+
+std::unique_ptr<MolData> PDBReader::read_atoms()
+{
+    if (!m_file)
+    {
+        throw mol::MolError("No opened file");
+    }
+
+    std::unique_ptr<MolData> mol_data = std::make_unique<MolData>(m_num_atoms);
+    AtomData &atoms = mol_data->atoms();
+    ElementsTable const& elements = ELEMENTS_TABLE();
+    Model const model = m_frames[0];
+
+    // Residue fields are kept as views of the mapping until residues
+    // are detected
+    std::vector<int> serials(m_num_atoms);
+    std::vector<int> resids(m_num_atoms);
+    std::vector<std::string_view> resnames(m_num_atoms);
+    std::vector<std::string_view> segids(m_num_atoms);
+    std::vector<std::string_view> chains(m_num_atoms);
+    std::atomic<bool> unknown { false };
+    {
+        StatsTimer timer(m_stats.decode_time);
+        text::parse_lines(chars() + model.begin, chars() + model.end, m_num_atoms, is_atom, [&](std::string_view const line, size_t const i)
+        {
+            serials[i] = text::to_int(text::field(line, 6, 5));
+            atoms.name(i) = text::trim(text::field(line, 12, 4));
+            atoms.type(i) = atoms.name(i);
+            atoms.altloc(i) = text::field(line, 16, 1);
+            resnames[i] = text::trim(text::field(line, 17, 4));
+            chains[i] = text::field(line, 21, 1);
+            resids[i] = text::to_int(text::field(line, 22, 4));
+            atoms.occupancy(i) = text::to_float(text::field(line, 54, 6));
+            atoms.tempfactor(i) = text::to_float(text::field(line, 60, 6));
+            segids[i] = text::trim(text::field(line, 72, 4));
+
+            int const atomic = element_atomic(text::field(line, 76, 2));
+            atoms.atomic(i) = atomic;
+            atoms.mass(i) = elements.mass(atomic);
+            atoms.radius(i) = elements.VDW_radius(atomic);
+            if (atomic == 0)
+            {
+                unknown.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+    m_stats.bytes_read += model.end - model.begin;
+
+    // Masses and radii are only given if all elements are known
+    if (unknown)
+    {
+        for (index_t i = 0; i < m_num_atoms; ++i)
+        {
+            atoms.mass(i) = 0;
+            atoms.radius(i) = 0;
+        }
+    }
+
+    ResidueDetect residues;
+    for (index_t i = 0; i < m_num_atoms; ++i)
+    {
+        atoms.residue(i) = residues.register_atom(resids[i], resnames[i], segids[i], chains[i]);
+    }
+    residues.update_residue_data(*mol_data);
+
+    read_bonds(*mol_data, serials);
+    return mol_data;
+}
+
+MolReader::Status PDBReader::check_timestep_read(MolData& atom_data)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (atom_data.size() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    return SUCCESS;
+}
+
+MolReader::Status PDBReader::skip_timestep()
+{
+    return seek_timestep(m_current + 1);
+}
+
+MolReader::Status PDBReader::seek_timestep(size_t const frame)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    index_frames(frame);
+    if (frame > m_frames.size())
+    {
+        m_current = m_frames.size();
+        return END;
+    }
+
+    count_skipped(m_current, frame);
+    m_current = frame;
+    return SUCCESS;
+}
+
+MolReader::Status PDBReader::read_timestep(Timestep& timestep)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (timestep.coords().cols() == 0 || timestep.is_view())
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if ((size_t)timestep.coords().cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    index_frames(m_current);
+    if (m_current >= m_frames.size())
+    {
+        return END;
+    }
+
+    Model const model = m_frames[m_current];
+    m_read_ahead.access(model.begin, model.end - model.begin);
+    {
+        StatsTimer timer(m_stats.decode_time);
+
+        char const *pos = chars() + model.begin;
+        char const *const end = chars() + model.end;
+        timestep.cell() = read_cell(pos, end, m_cell);
+
+        position_t *coords = timestep.coords().data();
+        text::parse_lines(pos, end, m_num_atoms, is_atom, [coords](std::string_view const line, size_t const i)
+        {
+            coords[3 * i] = text::to_float(text::field(line, 30, 8));
+            coords[3 * i + 1] = text::to_float(text::field(line, 38, 8));
+            coords[3 * i + 2] = text::to_float(text::field(line, 46, 8));
+        });
+    }
+    timestep.time() = 0;
+
+    m_stats.bytes_read += model.end - model.begin;
+    ++m_stats.frames_decoded;
+    ++m_current;
+    return SUCCESS;
+}
+
+char const *PDBReader::chars() const
+{
+    return reinterpret_cast<char const *>(m_file->data());
+}
+
+size_t PDBReader::scan_model(size_t const begin, size_t &num_atoms, size_t &num_conect) const
+{
+    char const *pos = chars() + begin;
+    char const *const end = chars() + m_file->size();
+    num_atoms = 0;
+    num_conect = 0;
+    while (pos < end)
+    {
+        std::string_view const line = text::next_line(pos, end);
+        if (is_atom(line))
+        {
+            ++num_atoms;
+        }
+        else if (line.starts_with("CONECT"))
+        {
+            ++num_conect;
+        }
+        else if (line.starts_with("END"))
+        {
+            break;
+        }
+    }
+
+    return pos - chars();
+}
+
+void PDBReader::index_frames(size_t const frame)
+{
+    size_t const file_size = m_file->size();
+    while (m_frames.size() <= frame && m_indexed < file_size)
+    {
+        // Models with fewer atoms, as an END record after the
+        // last ENDMDL, end the trajectory
+        size_t num_atoms = 0;
+        size_t num_conect = 0;
+        size_t const end = scan_model(m_indexed, num_atoms, num_conect);
+        if (num_atoms < m_num_atoms)
+        {
+            m_indexed = file_size;
+            break;
+        }
+
+        m_frames.push_back({m_indexed, end});
+        m_indexed = end;
+    }
+}
+
+void PDBReader::read_bonds(MolData &mol_data, std::vector<int> const& serials) const
+{
+    if (m_num_conect == 0 || m_num_atoms >= MAX_CONECT_ATOMS)
+    {
+        return;
+    }
+
+    std::vector<index_t> atoms(MAX_CONECT_ATOMS, -1);
+    for (index_t i = 0; i < m_num_atoms; ++i)
+    {
+        if (serials[i] >= 0 && (size_t)serials[i] < MAX_CONECT_ATOMS)
+        {
+            atoms[serials[i]] = i;
+        }
+    }
+
+    // Records list bonds both ways, so only the ones to higher
+    // serial numbers are added
+    BondData &bond_graph = mol_data.bonds();
+    bool incomplete = false;
+    Model const model = m_frames[0];
+    char const *pos = chars() + model.begin;
+    char const *const end = chars() + model.end;
+    while (pos < end)
+    {
+        std::string_view const line = text::next_line(pos, end);
+        if (!line.starts_with("CONECT"))
+        {
+            continue;
+        }
+
+        size_t const from = text::to_int(text::field(line, 6, 5));
+        for (size_t column = 11; column < CONECT_END && column + 5 <= line.size(); column += 5)
+        {
+            std::string_view const serial = text::trim(text::field(line, column, 5));
+            if (serial.empty())
+            {
+                break;
+            }
+
+            size_t const to = text::to_int(serial);
+            if (to <= from || to >= MAX_CONECT_ATOMS || from >= MAX_CONECT_ATOMS
+                || atoms[from] == (index_t)-1 || atoms[to] == (index_t)-1)
+            {
+                continue;
+            }
+
+            auto bond = bond_graph.add_bond(atoms[from], atoms[to]);
+            if (bond)
+            {
+                bond->set_guessed(false);
+                incomplete = true;
+            }
+        }
+    }
+
+    // Records usually only cover some of the bonds
+    if (incomplete)
+    {
+        bond_graph.set_incomplete(true);
+    }
+}
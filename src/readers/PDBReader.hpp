@@ -0,0 +1,69 @@
+#ifndef PDBREADER_HPP
+#define PDBREADER_HPP
+
+#include "MolReader.hpp"
+#include "ReadAhead.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace mol::internal {
+
+class MappedFile;
+
+// Native reader for PDB files. The file is memory-mapped and the
+// ATOM/HETATM records of large models are parsed in parallel, each
+// thread filling its own range of atom columns. Models end at END or
+// ENDMDL records and are indexed as they are reached, so seeking back
+// is O(1).
+class PDBReader : public MolReader
+{
+public:
+    PDBReader();
+    ~PDBReader();
+    static bool can_read(std::string const &file_ext);
+    bool has_topology() const override;
+    bool has_trajectory() const override;
+    bool has_bonds() const override;
+    bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
+    Status open(const std::string &file_name) override;
+    void close() override;
+    std::unique_ptr<MolData> read_atoms() override;
+    Status check_timestep_read(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
+
+private:
+    // Byte range of a model
+    struct Model
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    char const *chars() const;
+    // End of the model starting at the given offset
+    size_t scan_model(size_t const begin, size_t &num_atoms, size_t &num_conect) const;
+    // Indexes models until the given frame is known or the file ends
+    void index_frames(size_t const frame);
+    void read_bonds(MolData &mol_data, std::vector<int> const& serials) const;
+
+    std::shared_ptr<MappedFile> m_file;
+    ReadAhead m_read_ahead;
+    size_t m_num_atoms;
+    size_t m_num_conect;
+    // Cell of the file header, kept by models without their own
+    UnitCell m_cell;
+    std::vector<Model> m_frames;
+    // Offset models are indexed from
+    size_t m_indexed;
+    size_t m_current;
+};
+
+} // namespace mol::internal
+
+#endif // PDBREADER_HPP
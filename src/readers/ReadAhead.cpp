@@ -0,0 +1,106 @@
+#include "ReadAhead.hpp"
+#include <algorithm>
+
+#if __has_include(<sys/mman.h>) && __has_include(<fcntl.h>)
+#define MOLPP_HAS_ADVICE
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace mol::internal;
+
+ReadAhead::ReadAhead(size_t const window)
+: m_window { window },
+  m_fd { -1 },
+  m_data { nullptr },
+  m_size { 0 },
+  m_begin { 0 },
+  m_end { 0 }
+{}
+
+ReadAhead::~ReadAhead()
+{
+    close();
+}
+
+bool ReadAhead::open(std::string const& file_name)
+{
+    close();
+
+#ifdef MOLPP_HAS_ADVICE
+    // Advice applies to the file's pages, whatever the descriptor
+    // used to read them
+    m_fd = ::open(file_name.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+    m_size = lseek(m_fd, 0, SEEK_END);
+    return true;
+#else
+    (void)file_name;
+    return false;
+#endif
+}
+
+void ReadAhead::map(unsigned char const *data, size_t const size)
+{
+    close();
+    m_data = data;
+    m_size = size;
+}
+
+void ReadAhead::close()
+{
+#ifdef MOLPP_HAS_ADVICE
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+#endif
+    m_fd = -1;
+    m_data = nullptr;
+    m_size = 0;
+    m_begin = 0;
+    m_end = 0;
+}
+
+void ReadAhead::access(uint64_t const offset, uint64_t const size)
+{
+    uint64_t const end = offset + size;
+    if (offset >= m_begin && end + m_window / 2 <= m_end)
+    {
+        return;
+    }
+
+    // Sequential reads only request what is new
+    uint64_t const begin = (offset >= m_begin && offset < m_end) ? m_end : offset;
+    uint64_t const window_end = std::min<uint64_t>(std::max<uint64_t>(end, offset + m_window), m_size);
+    if (begin < window_end)
+    {
+        request(begin, window_end - begin);
+    }
+    m_begin = offset;
+    m_end = std::max(window_end, end);
+}
+
+void ReadAhead::request(uint64_t const offset, uint64_t const size)
+{
+#ifdef MOLPP_HAS_ADVICE
+    if (m_fd >= 0)
+    {
+        posix_fadvise(m_fd, offset, size, POSIX_FADV_WILLNEED);
+    }
+    else if (m_data)
+    {
+        // Advice ranges start on page boundaries
+        uint64_t const page = sysconf(_SC_PAGESIZE);
+        uint64_t const start = offset - offset % page;
+        madvise(const_cast<unsigned char *>(m_data) + start, offset + size - start, MADV_WILLNEED);
+    }
+#else
+    (void)offset;
+    (void)size;
+#endif
+}
@@ -0,0 +1,47 @@
+#ifndef READAHEAD_HPP
+#define READAHEAD_HPP
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace mol::internal {
+
+// Keeps the kernel fetching a window of a file ahead of the reads, so
+// that I/O overlaps with decoding instead of blocking each frame.
+// Works on files read through descriptors or mapped in memory. Where
+// advisory calls are not available, it does nothing.
+class ReadAhead
+{
+public:
+    static size_t const DEFAULT_WINDOW = 32 << 20;
+
+    ReadAhead(size_t const window = DEFAULT_WINDOW);
+    ReadAhead(ReadAhead const&) = delete;
+    ReadAhead& operator=(ReadAhead const&) = delete;
+    ~ReadAhead();
+    bool open(std::string const& file_name);
+    void map(unsigned char const *data, size_t const size);
+    void close();
+    // Tells that the given bytes are about to be read. A new window is
+    // requested once the reads went past half of the previous one or
+    // jumped out of it.
+    void access(uint64_t const offset, uint64_t const size);
+    // End of the bytes requested so far
+    uint64_t requested() const { return m_end; }
+
+private:
+    void request(uint64_t const offset, uint64_t const size);
+
+    size_t m_window;
+    int m_fd;
+    unsigned char const *m_data;
+    size_t m_size;
+    // Bytes already requested
+    uint64_t m_begin;
+    uint64_t m_end;
+};
+
+} // namespace mol::internal
+
+#endif // READAHEAD_HPP
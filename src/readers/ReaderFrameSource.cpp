@@ -0,0 +1,156 @@
+#include "ReaderFrameSource.hpp"
+#include "core/MolData.hpp"
+#include <molpp/MolError.hpp>
+
+using namespace mol::internal;
+
+ReaderFrameSource::ReaderFrameSource(std::shared_ptr<MolReader> reader, std::string const& file_name)
+: m_reader{reader},
+  m_file_name{file_name},
+  m_opened{false},
+  m_num_atoms{0},
+  m_num_frames{0},
+  m_begin{0},
+  m_step{1},
+  m_current{0}
+{}
+
+ReaderFrameSource::~ReaderFrameSource()
+{
+    if (m_opened)
+    {
+        m_reader->close();
+    }
+}
+
+MolReader::Status ReaderFrameSource::open(MolData& atom_data, int begin, int end, int step)
+{
+    // Sanity checks
+    if (!m_reader->has_trajectory() || m_opened)
+    {
+        return MolReader::INVALID;
+    }
+
+    MolReader::Status status = m_reader->open(m_file_name);
+    if (status != MolReader::SUCCESS)
+    {
+        return status;
+    }
+    m_opened = true;
+    m_num_atoms = atom_data.size();
+    m_current = 0;
+
+    status = m_reader->check_timestep_read(atom_data);
+    if (status != MolReader::SUCCESS)
+    {
+        return status;
+    }
+
+    // Count the frames without decoding them
+    size_t total = 0;
+    while (end < 0 || total < (size_t)end)
+    {
+        status = m_reader->skip_timestep();
+        if (status != MolReader::SUCCESS)
+        {
+            break;
+        }
+        ++total;
+    }
+    if (status != MolReader::SUCCESS && status != MolReader::END)
+    {
+        return status;
+    }
+    m_current = total;
+
+    m_begin = (begin < 0) ? 0 : begin;
+    m_step = (step < 1) ? 1 : step;
+    m_num_frames = (total > m_begin) ? (total - m_begin + m_step - 1) / m_step : 0;
+
+    return MolReader::SUCCESS;
+}
+
+size_t ReaderFrameSource::num_atoms() const
+{
+    return m_num_atoms;
+}
+
+size_t ReaderFrameSource::num_frames() const
+{
+    return m_num_frames;
+}
+
+void ReaderFrameSource::read(size_t const index, Timestep &timestep)
+{
+    if (index >= m_num_frames)
+    {
+        throw mol::MolError("Out of bounds frame: " + std::to_string(index));
+    }
+
+    size_t const frame = m_begin + index * m_step;
+    MolReader::Status status = skip(frame);
+    if (status == MolReader::SUCCESS)
+    {
+        status = m_reader->read_timestep(timestep);
+    }
+
+    if (status != MolReader::SUCCESS)
+    {
+        throw mol::MolError("Error reading frame " + std::to_string(frame) + " from file " + m_file_name);
+    }
+    ++m_current;
+}
+
+double ReaderFrameSource::time(size_t const index)
+{
+    double time = 0;
+    if (!m_opened || !m_reader->frame_time(m_begin + index * m_step, time))
+    {
+        return 0;
+    }
+    return time;
+}
+
+MolReader::Status ReaderFrameSource::rewind()
+{
+    if (m_opened)
+    {
+        m_reader->close();
+        m_opened = false;
+    }
+
+    MolReader::Status const status = m_reader->open(m_file_name);
+    m_opened = (status == MolReader::SUCCESS);
+    m_current = 0;
+    return status;
+}
+
+MolReader::Status ReaderFrameSource::skip(size_t const frame)
+{
+    if (!m_opened || (frame < m_current && !m_reader->can_seek()))
+    {
+        MolReader::Status const status = rewind();
+        if (status != MolReader::SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    if (m_reader->can_seek())
+    {
+        m_current = frame;
+        return m_reader->seek_timestep(frame);
+    }
+
+    while (m_current < frame)
+    {
+        MolReader::Status const status = m_reader->skip_timestep();
+        if (status != MolReader::SUCCESS)
+        {
+            return status;
+        }
+        ++m_current;
+    }
+
+    return MolReader::SUCCESS;
+}
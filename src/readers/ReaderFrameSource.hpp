@@ -0,0 +1,42 @@
+#ifndef READERFRAMESOURCE_HPP
+#define READERFRAMESOURCE_HPP
+
+#include "core/FrameSource.hpp"
+#include "readers/MolReader.hpp"
+#include <string>
+#include <memory>
+
+namespace mol::internal {
+
+// Frames decoded on demand from a trajectory file. The file
+// stays open and sequential accesses only move forward in it.
+class ReaderFrameSource : public FrameSource
+{
+public:
+    ReaderFrameSource() = delete;
+    ReaderFrameSource(std::shared_ptr<MolReader> reader, std::string const& file_name);
+    ~ReaderFrameSource();
+    MolReader::Status open(MolData& atom_data, int begin=0, int end=-1, int step=1);
+    size_t num_atoms() const override;
+    size_t num_frames() const override;
+    void read(size_t const index, Timestep &timestep) override;
+    double time(size_t const index) override;
+
+private:
+    MolReader::Status rewind();
+    MolReader::Status skip(size_t const frame);
+
+    std::shared_ptr<MolReader> m_reader;
+    std::string m_file_name;
+    bool m_opened;
+    size_t m_num_atoms;
+    size_t m_num_frames;
+    size_t m_begin;
+    size_t m_step;
+    // Next frame in the file
+    size_t m_current;
+};
+
+} // namespace mol::internal
+
+#endif // READERFRAMESOURCE_HPP
@@ -0,0 +1,139 @@
+#include "ResidueDetect.hpp"
+
+using namespace mol;
+using namespace mol::internal;
+
+namespace {
+
+index_t const NONE = -1;
+size_t const MIN_SLOTS = 64;
+
+size_t hash(int const resid, uint32_t const resname, uint32_t const segid, uint32_t const chain)
+{
+    uint64_t key = static_cast<uint32_t>(resid);
+    key = (key * 0x9E3779B97F4A7C15ull) ^ resname;
+    key = (key * 0x9E3779B97F4A7C15ull) ^ segid;
+    key = (key * 0x9E3779B97F4A7C15ull) ^ chain;
+    return key ^ (key >> 32);
+}
+
+} // namespace
+
+ResidueDetect::ResidueDetect()
+: m_slots(MIN_SLOTS, NONE),
+  m_current { NONE }
+{}
+
+index_t ResidueDetect::register_atom(int const resid, std::string_view const resname, std::string_view const segid, std::string_view const chain)
+{
+    // Atoms of a residue are usually consecutive
+    if (m_current != NONE)
+    {
+        Residue const &current = m_residues[m_current];
+        if (current.resid == resid
+            && m_names[current.resname] == resname
+            && m_names[current.segid] == segid
+            && m_names[current.chain] == chain)
+        {
+            return m_current;
+        }
+    }
+
+    m_current = find_or_add({resid, intern(resname), intern(segid), intern(chain)});
+    return m_current;
+}
+
+void ResidueDetect::update_residue_data(MolData& mol_data) const
+{
+    ResidueData &residues_data = mol_data.residues();
+    AtomData const &atoms = mol_data.atoms();
+    size_t const num_residues = m_residues.size();
+
+    // Atoms are sorted by residue, so that each one gets a
+    // contiguous range of them. Unregistered atoms are left out.
+    std::vector<size_t> offsets(num_residues + 1, 0);
+    for (index_t index = 0; index < mol_data.size(); ++index)
+    {
+        if (atoms.residue(index) < num_residues)
+        {
+            ++offsets[atoms.residue(index) + 1];
+        }
+    }
+    for (size_t residue = 0; residue < num_residues; ++residue)
+    {
+        offsets[residue + 1] += offsets[residue];
+    }
+
+    std::vector<index_t> sorted(offsets.back());
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (index_t index = 0; index < mol_data.size(); ++index)
+    {
+        if (atoms.residue(index) < num_residues)
+        {
+            sorted[next[atoms.residue(index)]++] = index;
+        }
+    }
+
+    residues_data.resize(num_residues);
+    for (index_t index = 0; index < num_residues; ++index)
+    {
+        Residue const &residue = m_residues[index];
+        residues_data.set(index, residue.resid, m_names[residue.resname], m_names[residue.segid], m_names[residue.chain]);
+        residues_data.assign(index, sorted.begin() + offsets[index], sorted.begin() + offsets[index + 1]);
+    }
+}
+
+uint32_t ResidueDetect::intern(std::string_view const name)
+{
+    auto const it = m_name_ids.find(name);
+    if (it != m_name_ids.end())
+    {
+        return it->second;
+    }
+
+    uint32_t const id = m_names.size();
+    m_names.emplace_back(name);
+    m_name_ids.emplace(m_names.back(), id);
+    return id;
+}
+
+index_t ResidueDetect::find_or_add(Residue const& residue)
+{
+    size_t const mask = m_slots.size() - 1;
+    size_t slot = hash(residue.resid, residue.resname, residue.segid, residue.chain) & mask;
+    while (m_slots[slot] != NONE)
+    {
+        if (m_residues[m_slots[slot]] == residue)
+        {
+            return m_slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    index_t const index = m_residues.size();
+    m_residues.push_back(residue);
+    m_slots[slot] = index;
+
+    // Kept at most half full, so that probes are short
+    if (2 * m_residues.size() > m_slots.size())
+    {
+        grow();
+    }
+    return index;
+}
+
+void ResidueDetect::grow()
+{
+    m_slots.assign(2 * m_slots.size(), NONE);
+    size_t const mask = m_slots.size() - 1;
+    for (index_t index = 0; index < m_residues.size(); ++index)
+    {
+        Residue const &residue = m_residues[index];
+        size_t slot = hash(residue.resid, residue.resname, residue.segid, residue.chain) & mask;
+        while (m_slots[slot] != NONE)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = index;
+    }
+}
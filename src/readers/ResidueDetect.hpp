@@ -2,72 +2,52 @@
 #define RESIDUEDETECT_HPP
 
 #include "core/MolData.hpp"
-#include <map>
+#include <unordered_map>
+#include <string_view>
 #include <string>
+#include <vector>
+#include <deque>
+#include <cstdint>
 
 namespace mol::internal {
 
+// Assigns atoms to residues, which are told apart by their resid,
+// resname, segid and chain. Names are interned, so that residues are
+// keys of four integers found in an open-addressing hash table. Atoms
+// of the same residue as the previous one are registered without
+// hashing.
 class ResidueDetect
 {
+public:
+    ResidueDetect();
+
+    index_t register_atom(int const resid, std::string_view const resname, std::string_view const segid, std::string_view const chain);
+    size_t size() const { return m_residues.size(); }
+    void update_residue_data(MolData& mol_data) const;
+
 private:
     struct Residue
     {
-        index_t index;
-        size_t count;
         int resid;
-        std::string resname;
-        std::string segid;
-        std::string chain;
-    };
-
-    using residues_type = std::map<std::tuple<int, std::string, std::string, std::string>, Residue>;
-
-    residues_type m_residues;
-    residues_type::iterator m_iterator;
-    Residue m_current;
-
-public:
-    ResidueDetect()
-    : m_iterator{m_residues.end()}
-    {}
-
-    index_t register_atom(int const resid, std::string const &resname, std::string const &segid, std::string const chain)
-    {
-        if (m_iterator == m_residues.end()
-            || m_current.resid != resid
-            || m_current.resname != resname
-            || m_current.segid != segid
-            || m_current.chain != chain)
-        {
-            index_t const index = m_residues.size();
-            m_current = {index, 0, resid, resname, segid, chain};
-
-            std::tuple const key{resid, resname, segid, chain};
-            m_iterator = m_residues.insert(std::pair(key, m_current)).first;
-        }
+        uint32_t resname;
+        uint32_t segid;
+        uint32_t chain;
 
-        Residue &residue = m_iterator->second;
-        residue.count++;
-        return residue.index;
-    }
-
-    void update_residue_data(MolData& mol_data) const
-    {
-        ResidueData &residues_data = mol_data.residues();
-        residues_data.resize(m_residues.size());
-        for (auto const &item : m_residues)
-        {
-            Residue const &residue = item.second;
-            residues_data.reset(residue.index, residue.count);
-            residues_data.set(residue.index, residue.resid, residue.resname, residue.segid, residue.chain);
-        }
+        bool operator==(Residue const&) const = default;
+    };
 
-        for (index_t index = 0; index < mol_data.size(); ++index)
-        {
-            index_t const residue_idx = mol_data.atoms().residue(index);
-            residues_data.add_atom(residue_idx, index);
-        }
-    }
+    uint32_t intern(std::string_view const name);
+    // Index of the residue, which is added if new
+    index_t find_or_add(Residue const& residue);
+    void grow();
+
+    // Names by id, in a deque so that views of them stay valid
+    std::deque<std::string> m_names;
+    std::unordered_map<std::string_view, uint32_t> m_name_ids;
+    std::vector<Residue> m_residues;
+    // Residue indices by hash, with linear probing
+    std::vector<index_t> m_slots;
+    index_t m_current;
 };
 
 } // namespace mol::internal
@@ -0,0 +1,140 @@
+#include "Snapshot.hpp"
+#include "core/MolData.hpp"
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+using namespace mol;
+using namespace mol::internal;
+
+namespace {
+
+static_assert(sizeof(snapshot::Header) == 56);
+static_assert(sizeof(snapshot::BondRecord) == 24);
+
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(std::string const& file_name)
+    : m_stream(file_name, std::ios::binary | std::ios::trunc)
+    {}
+
+    bool good() const
+    {
+        return m_stream.good();
+    }
+
+    template <class T>
+    void write(T const *data, size_t const count)
+    {
+        size_t const size = sizeof(T) * count;
+        m_stream.write(reinterpret_cast<char const *>(data), size);
+        pad(size);
+    }
+
+    template <class T, class Getter>
+    void column(size_t const count, Getter const& getter)
+    {
+        std::vector<T> values(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = getter(i);
+        }
+        write(values.data(), count);
+    }
+
+    template <class Getter>
+    void strings(size_t const count, Getter const& getter)
+    {
+        std::vector<uint64_t> offsets(count + 1, 0);
+        std::string chars;
+        for (size_t i = 0; i < count; ++i)
+        {
+            chars += getter(i);
+            offsets[i + 1] = chars.size();
+        }
+        write(offsets.data(), offsets.size());
+        write(chars.data(), chars.size());
+    }
+
+private:
+    void pad(size_t const size)
+    {
+        char const zeros[snapshot::ALIGNMENT] = {};
+        m_stream.write(zeros, snapshot::aligned(size) - size);
+    }
+
+    std::ofstream m_stream;
+};
+
+} // namespace
+
+bool snapshot::write(MolData const& data, std::string const& file_name, bool const with_trajectory)
+{
+    SnapshotWriter writer(file_name);
+    if (!writer.good())
+    {
+        return false;
+    }
+
+    std::vector<BondRecord> bond_records;
+    bond_records.reserve(data.bonds().size());
+    for (auto const& bond : data.bonds().bonds())
+    {
+        uint32_t flags = 0;
+        flags |= bond->guessed() ? GUESSED : 0;
+        flags |= bond->guessed_order() ? GUESSED_ORDER : 0;
+        flags |= bond->aromatic() ? AROMATIC : 0;
+        bond_records.push_back({bond->atom1(), bond->atom2(), bond->order(), flags});
+    }
+
+    Trajectory const& trajectory = data.trajectory();
+    ResidueData const& residues = data.residues();
+    AtomData const& atoms = data.atoms();
+    size_t const num_atoms = data.size();
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.byte_order = ENDIAN_CHECK;
+    header.num_atoms = num_atoms;
+    header.num_residues = residues.size();
+    header.num_bonds = bond_records.size();
+    header.num_frames = with_trajectory ? trajectory.num_frames() : 0;
+    header.flags = data.bonds().incomplete() ? BONDS_INCOMPLETE : 0;
+    header.reserved = 0;
+    writer.write(&header, 1);
+
+    writer.column<uint64_t>(num_atoms, [&atoms](index_t i) { return atoms.residue(i); });
+    writer.column<int64_t>(num_atoms, [&atoms](index_t i) { return atoms.atomic(i); });
+    writer.column<float>(num_atoms, [&atoms](index_t i) { return atoms.occupancy(i); });
+    writer.column<float>(num_atoms, [&atoms](index_t i) { return atoms.tempfactor(i); });
+    writer.column<float>(num_atoms, [&atoms](index_t i) { return atoms.mass(i); });
+    writer.column<float>(num_atoms, [&atoms](index_t i) { return atoms.charge(i); });
+    writer.column<float>(num_atoms, [&atoms](index_t i) { return atoms.radius(i); });
+    writer.strings(num_atoms, [&atoms](index_t i) { return atoms.name(i); });
+    writer.strings(num_atoms, [&atoms](index_t i) { return atoms.type(i); });
+    writer.strings(num_atoms, [&atoms](index_t i) { return atoms.altloc(i); });
+
+    writer.column<int32_t>(residues.size(), [&residues](index_t i) { return residues.resid(i); });
+    writer.strings(residues.size(), [&residues](index_t i) { return residues.resname(i); });
+    writer.strings(residues.size(), [&residues](index_t i) { return residues.segid(i); });
+    writer.strings(residues.size(), [&residues](index_t i) { return residues.chain(i); });
+
+    writer.write(bond_records.data(), bond_records.size());
+
+    // The time takes the room of two floats
+    std::vector<float> frame(frame_size(num_atoms) / sizeof(float), 0);
+    for (size_t i = 0; i < header.num_frames; ++i)
+    {
+        Timestep const& timestep = trajectory.timestep(i);
+        double const time = timestep.time();
+        std::memcpy(frame.data(), &time, sizeof(time));
+        Eigen::Map<Point3>(frame.data() + 2) = timestep.cell().lengths();
+        Eigen::Map<Point3>(frame.data() + 5) = timestep.cell().angles();
+        Eigen::Map<Coord3>(frame.data() + 8, 3, num_atoms) = timestep.coords();
+        writer.write(frame.data(), frame.size());
+    }
+
+    return writer.good();
+}
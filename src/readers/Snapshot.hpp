@@ -0,0 +1,78 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace mol::internal {
+
+class MolData;
+
+/*
+ * Binary snapshots of MolData. Layout, in native byte order:
+ *  - Header
+ *  - Atoms: residue, atomic, occupancy, tempfactor, mass, charge and
+ *    radius columns, then name, type and altloc string tables
+ *  - Residues: resid column, then resname, segid and chain string tables
+ *  - Bonds: BondRecord array
+ *  - Frames: time as a double, unit cell lengths and angles, and then
+ *    coordinates
+ * String tables are num + 1 offsets followed by the characters. Every
+ * column starts at a multiple of ALIGNMENT bytes.
+ */
+namespace snapshot {
+
+char const MAGIC[8] = {'M', 'O', 'L', 'P', 'P', 'S', 'N', 'P'};
+uint32_t const VERSION = 2;
+uint32_t const ENDIAN_CHECK = 0x01020304;
+size_t const ALIGNMENT = 8;
+
+// Header flags
+uint32_t const BONDS_INCOMPLETE = 1;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t num_atoms;
+    uint64_t num_residues;
+    uint64_t num_bonds;
+    uint64_t num_frames;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+// Bond flags
+uint32_t const GUESSED = 1;
+uint32_t const GUESSED_ORDER = 2;
+uint32_t const AROMATIC = 4;
+
+struct BondRecord
+{
+    uint64_t atom1;
+    uint64_t atom2;
+    int32_t order;
+    uint32_t flags;
+};
+
+inline size_t aligned(size_t const size)
+{
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+inline size_t frame_size(size_t const num_atoms)
+{
+    return aligned(sizeof(double) + sizeof(float) * (6 + 3 * num_atoms));
+}
+
+// Writes data into file_name, including its frames if asked to.
+// Returns false on I/O errors.
+bool write(MolData const& data, std::string const& file_name, bool const with_trajectory);
+
+} // namespace snapshot
+
+} // namespace mol::internal
+
+#endif // SNAPSHOT_HPP
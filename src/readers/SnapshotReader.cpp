@@ -0,0 +1,405 @@
+#include "SnapshotReader.hpp"
+#include "Snapshot.hpp"
+#include "MappedFile.hpp"
+#include "core/MolData.hpp"
+#include <cstring>
+
+using namespace mol;
+using namespace mol::internal;
+using namespace mol::internal::snapshot;
+
+namespace {
+
+// Bounds-checked walk over the snapshot's columns
+class SnapshotCursor
+{
+public:
+    SnapshotCursor(unsigned char const *data, size_t const size)
+    : m_data { data },
+      m_size { size },
+      m_offset { sizeof(Header) }
+    {}
+
+    size_t offset() const
+    {
+        return m_offset;
+    }
+
+    template <class T>
+    T const *column(size_t const count)
+    {
+        size_t const size = sizeof(T) * count;
+        if (m_offset > m_size || size > m_size - m_offset)
+        {
+            return nullptr;
+        }
+
+        T const *data = reinterpret_cast<T const *>(m_data + m_offset);
+        m_offset += aligned(size);
+        return data;
+    }
+
+    // The setter receives each string as an index, a pointer
+    // and a size. Null setters only skip the table.
+    template <class Setter>
+    bool strings(size_t const count, Setter const& setter)
+    {
+        uint64_t const *offsets = column<uint64_t>(count + 1);
+        if (!offsets)
+        {
+            return false;
+        }
+
+        char const *chars = column<char>(offsets[count]);
+        if (!chars)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > offsets[count])
+            {
+                return false;
+            }
+            setter(i, chars + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+        return true;
+    }
+
+private:
+    unsigned char const *m_data;
+    size_t m_size;
+    size_t m_offset;
+};
+
+// Fills data, if given, with all sections but the frames. Returns false
+// for truncated or corrupted files.
+bool read_sections(SnapshotCursor &cursor, Header const& header, MolData *data)
+{
+    size_t const num_atoms = header.num_atoms;
+    size_t const num_residues = header.num_residues;
+    auto const ignore = [](size_t const, char const *, size_t const) {};
+
+    uint64_t const *residue = cursor.column<uint64_t>(num_atoms);
+    int64_t const *atomic = cursor.column<int64_t>(num_atoms);
+    float const *occupancy = cursor.column<float>(num_atoms);
+    float const *tempfactor = cursor.column<float>(num_atoms);
+    float const *mass = cursor.column<float>(num_atoms);
+    float const *charge = cursor.column<float>(num_atoms);
+    float const *radius = cursor.column<float>(num_atoms);
+    if (!residue || !atomic || !occupancy || !tempfactor || !mass || !charge || !radius)
+    {
+        return false;
+    }
+
+    AtomData *atoms = data ? &data->atoms() : nullptr;
+    if (atoms)
+    {
+        for (index_t i = 0; i < num_atoms; ++i)
+        {
+            atoms->residue(i) = residue[i];
+            atoms->atomic(i) = atomic[i];
+            atoms->occupancy(i) = occupancy[i];
+            atoms->tempfactor(i) = tempfactor[i];
+            atoms->mass(i) = mass[i];
+            atoms->charge(i) = charge[i];
+            atoms->radius(i) = radius[i];
+        }
+    }
+
+    bool const atom_strings = atoms
+        ? cursor.strings(num_atoms, [atoms](size_t const i, char const *chars, size_t const size) { atoms->name(i).assign(chars, size); })
+          && cursor.strings(num_atoms, [atoms](size_t const i, char const *chars, size_t const size) { atoms->type(i).assign(chars, size); })
+          && cursor.strings(num_atoms, [atoms](size_t const i, char const *chars, size_t const size) { atoms->altloc(i).assign(chars, size); })
+        : cursor.strings(num_atoms, ignore) && cursor.strings(num_atoms, ignore) && cursor.strings(num_atoms, ignore);
+    if (!atom_strings)
+    {
+        return false;
+    }
+
+    int32_t const *resid = cursor.column<int32_t>(num_residues);
+    if (!resid)
+    {
+        return false;
+    }
+
+    ResidueData *residues = data ? &data->residues() : nullptr;
+    if (residues)
+    {
+        residues->resize(num_residues);
+        for (index_t i = 0; i < num_residues; ++i)
+        {
+            residues->resid(i) = resid[i];
+        }
+    }
+
+    bool const residue_strings = residues
+        ? cursor.strings(num_residues, [residues](size_t const i, char const *chars, size_t const size) { residues->resname(i).assign(chars, size); })
+          && cursor.strings(num_residues, [residues](size_t const i, char const *chars, size_t const size) { residues->segid(i).assign(chars, size); })
+          && cursor.strings(num_residues, [residues](size_t const i, char const *chars, size_t const size) { residues->chain(i).assign(chars, size); })
+        : cursor.strings(num_residues, ignore) && cursor.strings(num_residues, ignore) && cursor.strings(num_residues, ignore);
+    if (!residue_strings)
+    {
+        return false;
+    }
+
+    BondRecord const *bonds = cursor.column<BondRecord>(header.num_bonds);
+    if (!bonds)
+    {
+        return false;
+    }
+
+    if (!data)
+    {
+        return true;
+    }
+
+    // Residue membership follows from the atoms
+    std::vector<size_t> residue_sizes(num_residues, 0);
+    for (index_t i = 0; i < num_atoms; ++i)
+    {
+        if (residue[i] < num_residues)
+        {
+            residue_sizes[residue[i]]++;
+        }
+    }
+    for (index_t i = 0; i < num_residues; ++i)
+    {
+        residues->reset(i, residue_sizes[i]);
+    }
+    for (index_t i = 0; i < num_atoms; ++i)
+    {
+        if (residue[i] < num_residues)
+        {
+            residues->add_atom(residue[i], i);
+        }
+    }
+
+    BondData &bond_data = data->bonds();
+    for (size_t i = 0; i < header.num_bonds; ++i)
+    {
+        BondRecord const &record = bonds[i];
+        if (record.atom1 >= num_atoms || record.atom2 >= num_atoms)
+        {
+            return false;
+        }
+
+        auto bond = bond_data.add_bond(record.atom1, record.atom2);
+        if (bond)
+        {
+            bond->set_order(record.order);
+            bond->set_guessed(record.flags & GUESSED);
+            bond->set_guessed_order(record.flags & GUESSED_ORDER);
+            bond->set_aromatic(record.flags & AROMATIC);
+        }
+    }
+    bond_data.set_incomplete(header.flags & BONDS_INCOMPLETE);
+
+    return true;
+}
+
+} // namespace
+
+SnapshotReader::SnapshotReader()
+: m_num_atoms { 0 },
+  m_num_frames { 0 },
+  m_frames_offset { 0 },
+  m_current { 0 }
+{}
+
+SnapshotReader::~SnapshotReader()
+{
+    close();
+}
+
+bool SnapshotReader::can_read(std::string const &file_ext)
+{
+    return file_ext == ".molpp" && MappedFile::supported();
+}
+
+bool SnapshotReader::has_topology() const
+{
+    return true;
+}
+
+bool SnapshotReader::has_trajectory() const
+{
+    return true;
+}
+
+bool SnapshotReader::has_bonds() const
+{
+    return true;
+}
+
+bool SnapshotReader::has_trajectory_metadata() const
+{
+    return false;
+}
+
+bool SnapshotReader::can_seek() const
+{
+    return true;
+}
+
+MolReader::Status SnapshotReader::open(const std::string &file_name)
+{
+    if (m_file)
+    {
+        return INVALID;
+    }
+
+    m_file = std::make_shared<MappedFile>();
+    if (!m_file->open(file_name) || m_file->size() < sizeof(Header))
+    {
+        close();
+        return FAILED;
+    }
+
+    // Snapshots are not portable across byte orders
+    Header header;
+    std::memcpy(&header, m_file->data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.version != VERSION
+        || header.byte_order != ENDIAN_CHECK
+        || header.num_atoms == 0)
+    {
+        close();
+        return FAILED;
+    }
+
+    // Frames come after all the other sections
+    SnapshotCursor cursor(m_file->data(), m_file->size());
+    if (!read_sections(cursor, header, nullptr)
+        || (m_file->size() - cursor.offset()) / frame_size(header.num_atoms) < header.num_frames)
+    {
+        close();
+        return FAILED;
+    }
+
+    m_num_atoms = header.num_atoms;
+    m_num_frames = header.num_frames;
+    m_frames_offset = cursor.offset();
+    m_current = 0;
+
+    return SUCCESS;
+}
+
+void SnapshotReader::close()
+{
+    // Timesteps still referencing the mapping keep it alive
+    m_file.reset();
+    m_num_atoms = 0;
+    m_num_frames = 0;
+    m_frames_offset = 0;
+    m_current = 0;
+}
+
+std::unique_ptr<MolData> SnapshotReader::read_atoms()
+{
+    if (!m_file)
+    {
+        throw mol::MolError("No opened file");
+    }
+
+    Header header;
+    std::memcpy(&header, m_file->data(), sizeof(header));
+    std::unique_ptr<MolData> mol_data = std::make_unique<MolData>(m_num_atoms);
+    SnapshotCursor cursor(m_file->data(), m_file->size());
+    if (!read_sections(cursor, header, mol_data.get()))
+    {
+        return nullptr;
+    }
+
+    return mol_data;
+}
+
+MolReader::Status SnapshotReader::check_timestep_read(MolData& atom_data)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (atom_data.size() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    return SUCCESS;
+}
+
+MolReader::Status SnapshotReader::skip_timestep()
+{
+    return seek_timestep(m_current + 1);
+}
+
+MolReader::Status SnapshotReader::seek_timestep(size_t const frame)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    if (frame > m_num_frames)
+    {
+        m_current = m_num_frames;
+        return END;
+    }
+
+    count_skipped(m_current, frame);
+    m_current = frame;
+    return SUCCESS;
+}
+
+bool SnapshotReader::frame_time(size_t const frame, double &time)
+{
+    if (!m_file || frame >= m_num_frames)
+    {
+        return false;
+    }
+
+    // Frames start with their time
+    std::memcpy(&time, m_file->data() + m_frames_offset + frame * frame_size(m_num_atoms), sizeof(time));
+    return true;
+}
+
+MolReader::Status SnapshotReader::read_timestep(Timestep& timestep)
+{
+    if (!m_file)
+    {
+        return INVALID;
+    }
+
+    size_t const num_atoms = timestep.is_view() ? 0 : timestep.coords().cols();
+    if (num_atoms != 0 && num_atoms != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    if (m_current >= m_num_frames)
+    {
+        return END;
+    }
+
+    // Mapped pages are private, so views can be freely modified
+    position_t *frame = reinterpret_cast<position_t *>(m_file->data() + m_frames_offset + m_current * frame_size(m_num_atoms));
+    position_t *coords = frame + 8;
+    if (num_atoms == 0)
+    {
+        timestep = Timestep(coords, m_num_atoms, m_file);
+    }
+    else
+    {
+        StatsTimer timer(m_stats.copy_time);
+        std::memcpy(timestep.coords().data(), coords, 3 * m_num_atoms * sizeof(position_t));
+    }
+    timestep.cell() = UnitCell(Point3(frame[2], frame[3], frame[4]), Point3(frame[5], frame[6], frame[7]));
+    frame_time(m_current, timestep.time());
+
+    m_stats.bytes_read += frame_size(m_num_atoms);
+    ++m_stats.frames_decoded;
+    ++m_current;
+    return SUCCESS;
+}
@@ -0,0 +1,47 @@
+#ifndef SNAPSHOTREADER_HPP
+#define SNAPSHOTREADER_HPP
+
+#include "MolReader.hpp"
+#include <string>
+#include <memory>
+
+namespace mol::internal {
+
+class MappedFile;
+
+// Reader for molpp's binary snapshots (see Snapshot.hpp). Columns are
+// copied in bulk from the memory-mapped file and frames, if any, are
+// handed out as zero-copy views of it.
+class SnapshotReader : public MolReader
+{
+public:
+    SnapshotReader();
+    ~SnapshotReader();
+    static bool can_read(std::string const &file_ext);
+    bool has_topology() const override;
+    bool has_trajectory() const override;
+    bool has_bonds() const override;
+    bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
+    Status open(const std::string &file_name) override;
+    void close() override;
+    std::unique_ptr<MolData> read_atoms() override;
+    Status check_timestep_read(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    bool frame_time(size_t const frame, double &time) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
+
+private:
+    std::shared_ptr<MappedFile> m_file;
+    size_t m_num_atoms;
+    size_t m_num_frames;
+    size_t m_frames_offset;
+    size_t m_current;
+};
+
+} // namespace mol::internal
+
+#endif // SNAPSHOTREADER_HPP
@@ -0,0 +1,255 @@
+#include "TRRReader.hpp"
+#include "trr.hpp"
+#include "core/MolData.hpp"
+#include <algorithm>
+
+using namespace mol::internal;
+
+TRRReader::TRRReader()
+: m_num_atoms { 0 },
+  m_current { 0 }
+{}
+
+TRRReader::~TRRReader()
+{
+    close();
+}
+
+bool TRRReader::can_read(std::string const &file_ext)
+{
+    return file_ext == ".trr";
+}
+
+bool TRRReader::has_topology() const
+{
+    return false;
+}
+
+bool TRRReader::has_trajectory() const
+{
+    return true;
+}
+
+bool TRRReader::has_bonds() const
+{
+    return false;
+}
+
+bool TRRReader::has_trajectory_metadata() const
+{
+    return false;
+}
+
+bool TRRReader::can_seek() const
+{
+    return true;
+}
+
+MolReader::Status TRRReader::open(const std::string &file_name)
+{
+    if (m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    m_file.open(file_name, std::ios::binary);
+    if (!m_file)
+    {
+        close();
+        return FAILED;
+    }
+
+    // The first header tells the number of atoms
+    trr::Header header;
+    m_buffer.resize(trr::PREFIX_SIZE);
+    m_file.read(reinterpret_cast<char *>(m_buffer.data()), m_buffer.size());
+    if (!trr::read_header(m_buffer.data(), m_file.gcount(), header))
+    {
+        close();
+        return FAILED;
+    }
+    m_num_atoms = header.num_atoms;
+
+    if (!m_index.load(file_name))
+    {
+        if (!build_index())
+        {
+            close();
+            return FAILED;
+        }
+        // Not being able to persist the index is not an error
+        m_index.save(file_name);
+    }
+
+    // Reading ahead is only an optimization
+    m_read_ahead.open(file_name);
+    return SUCCESS;
+}
+
+void TRRReader::close()
+{
+    m_file.close();
+    m_file.clear();
+    m_index.clear();
+    m_read_ahead.close();
+    m_num_atoms = 0;
+    m_current = 0;
+}
+
+std::unique_ptr<MolData> TRRReader::read_atoms()
+{
+    return nullptr;
+}
+
+MolReader::Status TRRReader::check_timestep_read(MolData& atom_data)
+{
+    if (!m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    if (atom_data.size() != (size_t)m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    return SUCCESS;
+}
+
+MolReader::Status TRRReader::skip_timestep()
+{
+    return seek_timestep(m_current + 1);
+}
+
+MolReader::Status TRRReader::seek_timestep(size_t const frame)
+{
+    if (!m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    if (frame > m_index.size())
+    {
+        m_current = m_index.size();
+        return END;
+    }
+
+    count_skipped(m_current, frame);
+    m_current = frame;
+    return SUCCESS;
+}
+
+MolReader::Status TRRReader::read_timestep(Timestep& timestep)
+{
+    if (!m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    if (timestep.coords().cols() == 0 || timestep.is_view())
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if (timestep.coords().cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    if (m_current >= m_index.size())
+    {
+        return END;
+    }
+
+    // Velocities and forces, stored after the coordinates, are not read
+    trr::Header header;
+    m_buffer.resize(trr::PREFIX_SIZE);
+    m_read_ahead.access(m_index.offset(m_current), m_index.frame_size(m_current));
+    {
+        StatsTimer timer(m_stats.io_time);
+        m_file.clear();
+        m_file.seekg(m_index.offset(m_current));
+        m_file.read(reinterpret_cast<char *>(m_buffer.data()), m_buffer.size());
+    }
+    if (!trr::read_header(m_buffer.data(), m_file.gcount(), header))
+    {
+        return FAILED;
+    }
+
+    // The header is read again along with the coordinates
+    m_buffer.resize(trr::coords_end(header));
+    track_buffer(m_buffer.capacity());
+    {
+        StatsTimer timer(m_stats.io_time);
+        m_file.clear();
+        m_file.seekg(m_index.offset(m_current));
+        m_file.read(reinterpret_cast<char *>(m_buffer.data()), m_buffer.size());
+    }
+    if (!m_file)
+    {
+        return FAILED;
+    }
+    m_stats.bytes_read += trr::PREFIX_SIZE + m_buffer.size();
+
+    Box3 box;
+    {
+        StatsTimer timer(m_stats.decode_time);
+        if (!trr::read_coords(m_buffer.data(), header, box.data(), timestep.coords().data()))
+        {
+            return FAILED;
+        }
+    }
+    timestep.cell() = UnitCell::from_vectors(box);
+    timestep.time() = header.time;
+
+    ++m_stats.frames_decoded;
+    ++m_current;
+    return SUCCESS;
+}
+
+bool TRRReader::frame_time(size_t const frame, double &time)
+{
+    if (!m_file.is_open() || frame >= m_index.size())
+    {
+        return false;
+    }
+
+    // Known from the frame headers read by the index
+    time = m_index.time(frame);
+    return true;
+}
+
+bool TRRReader::build_index()
+{
+    StatsTimer timer(m_stats.io_time);
+    m_file.clear();
+    m_file.seekg(0, std::ios::end);
+    uint64_t const file_size = m_file.tellg();
+    uint64_t offset = 0;
+    trr::Header header;
+
+    // Only frame headers are read. Scanning stops at the
+    // first truncated or invalid frame.
+    m_index.clear();
+    m_buffer.resize(trr::PREFIX_SIZE);
+    while (offset < file_size)
+    {
+        m_file.clear();
+        m_file.seekg(offset);
+        m_file.read(reinterpret_cast<char *>(m_buffer.data()), m_buffer.size());
+        m_stats.bytes_read += m_file.gcount();
+        if (!trr::read_header(m_buffer.data(), m_file.gcount(), header)
+            || header.num_atoms != m_num_atoms
+            || offset + trr::frame_size(header) > file_size)
+        {
+            break;
+        }
+
+        if (header.x_size)
+        {
+            m_index.add_frame(offset, trr::frame_size(header), header.time);
+        }
+        offset += trr::frame_size(header);
+    }
+
+    return m_index.size();
+}
@@ -0,0 +1,51 @@
+#ifndef TRRREADER_HPP
+#define TRRREADER_HPP
+
+#include "MolReader.hpp"
+#include "FrameIndex.hpp"
+#include "ReadAhead.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace mol::internal {
+
+// Native reader for Gromacs' TRR trajectories. Frame headers are
+// indexed on the first open, so skipping and seeking are O(1). Frames
+// without coordinates (e.g. velocity-only output) are not indexed.
+class TRRReader : public MolReader
+{
+public:
+    TRRReader();
+    ~TRRReader();
+    static bool can_read(std::string const &file_ext);
+    bool has_topology() const override;
+    bool has_trajectory() const override;
+    bool has_bonds() const override;
+    bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
+    Status open(const std::string &file_name) override;
+    void close() override;
+    std::unique_ptr<MolData> read_atoms() override;
+    Status check_timestep_read(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    bool frame_time(size_t const frame, double &time) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
+
+private:
+    bool build_index();
+
+    int m_num_atoms;
+    size_t m_current;
+    std::ifstream m_file;
+    FrameIndex m_index;
+    ReadAhead m_read_ahead;
+    std::vector<unsigned char> m_buffer;
+};
+
+} // namespace mol::internal
+
+#endif // TRRREADER_HPP
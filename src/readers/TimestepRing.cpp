@@ -0,0 +1,67 @@
+#include "TimestepRing.hpp"
+
+using namespace mol;
+using namespace mol::internal;
+
+TimestepRing::TimestepRing(size_t const capacity)
+: m_slots(capacity),
+  m_frames(capacity),
+  m_head { 0 },
+  m_count { 0 },
+  m_closed { false }
+{}
+
+Timestep *TimestepRing::acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] { return m_closed || m_count < m_slots.size(); });
+    if (m_closed)
+    {
+        return nullptr;
+    }
+
+    // Only the consumer touches filled slots
+    return &m_slots[(m_head + m_count) % m_slots.size()];
+}
+
+void TimestepRing::publish(size_t const frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frames[(m_head + m_count) % m_slots.size()] = frame;
+        ++m_count;
+    }
+    m_cond.notify_all();
+}
+
+Timestep *TimestepRing::front(size_t &frame)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] { return m_closed || m_count > 0; });
+    if (m_count == 0)
+    {
+        return nullptr;
+    }
+
+    frame = m_frames[m_head];
+    return &m_slots[m_head];
+}
+
+void TimestepRing::pop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_head = (m_head + 1) % m_slots.size();
+        --m_count;
+    }
+    m_cond.notify_all();
+}
+
+void TimestepRing::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+    }
+    m_cond.notify_all();
+}
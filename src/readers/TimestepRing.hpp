@@ -0,0 +1,43 @@
+#ifndef TIMESTEPRING_HPP
+#define TIMESTEPRING_HPP
+
+#include <molpp/Timestep.hpp>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+namespace mol::internal {
+
+// Bounded queue of timesteps between a single producer and a single
+// consumer thread. Slots are recycled, so their buffers are reused.
+class TimestepRing
+{
+public:
+    TimestepRing(size_t const capacity);
+
+    // Producer side. Waits for a free slot, returning
+    // nullptr if the ring was closed.
+    Timestep *acquire();
+    void publish(size_t const frame);
+
+    // Consumer side. Waits for a filled slot, returning nullptr
+    // if the ring was closed and there is nothing left.
+    Timestep *front(size_t &frame);
+    void pop();
+
+    // Either side may close the ring to stop the other
+    void close();
+
+private:
+    std::vector<Timestep> m_slots;
+    std::vector<size_t> m_frames;
+    size_t m_head;
+    size_t m_count;
+    bool m_closed;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+} // namespace mol::internal
+
+#endif // TIMESTEPRING_HPP
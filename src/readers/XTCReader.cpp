@@ -0,0 +1,362 @@
+#include "XTCReader.hpp"
+#include "xtc.hpp"
+#include "core/MolData.hpp"
+#include "tools/ThreadPool.hpp"
+#include <algorithm>
+
+using namespace mol::internal;
+
+// Shared by all readers, so that loading several
+// files at once does not oversubscribe the CPUs.
+static ThreadPool &decode_pool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+static bool read_frame(unsigned char const *data, size_t const size, mol::Timestep &timestep)
+{
+    xtc::Header header;
+    if (!xtc::read_header(data, size, header) || !xtc::read_coords(data, size, timestep.coords().data()))
+    {
+        return false;
+    }
+
+    // Box vectors are in nanometers
+    timestep.cell() = mol::UnitCell::from_vectors(mol::Box3(header.box) * 10);
+    timestep.time() = header.time;
+    return true;
+}
+
+XTCReader::XTCReader()
+: m_num_atoms { 0 },
+  m_current { 0 }
+{}
+
+XTCReader::~XTCReader()
+{
+    close();
+}
+
+bool XTCReader::can_read(std::string const &file_ext)
+{
+    return file_ext == ".xtc";
+}
+
+bool XTCReader::has_topology() const
+{
+    return false;
+}
+
+bool XTCReader::has_trajectory() const
+{
+    return true;
+}
+
+bool XTCReader::has_bonds() const
+{
+    return false;
+}
+
+bool XTCReader::has_trajectory_metadata() const
+{
+    return false;
+}
+
+bool XTCReader::can_seek() const
+{
+    return true;
+}
+
+MolReader::Status XTCReader::open(const std::string &file_name)
+{
+    if (m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    m_file.open(file_name, std::ios::binary);
+    if (!m_file)
+    {
+        close();
+        return FAILED;
+    }
+
+    // The first header tells the number of atoms
+    xtc::Header header;
+    m_buffer.resize(xtc::PREFIX_SIZE);
+    m_file.read(reinterpret_cast<char *>(m_buffer.data()), m_buffer.size());
+    if (!xtc::read_header(m_buffer.data(), m_file.gcount(), header))
+    {
+        close();
+        return FAILED;
+    }
+    m_num_atoms = header.num_atoms;
+
+    if (!m_index.load(file_name))
+    {
+        if (!build_index())
+        {
+            close();
+            return FAILED;
+        }
+        // Not being able to persist the index is not an error
+        m_index.save(file_name);
+    }
+
+    // Reading ahead is only an optimization
+    m_read_ahead.open(file_name);
+    return SUCCESS;
+}
+
+void XTCReader::close()
+{
+    m_file.close();
+    m_file.clear();
+    m_index.clear();
+    m_read_ahead.close();
+    m_num_atoms = 0;
+    m_current = 0;
+}
+
+std::unique_ptr<MolData> XTCReader::read_atoms()
+{
+    return nullptr;
+}
+
+MolReader::Status XTCReader::check_timestep_read(MolData& atom_data)
+{
+    if (!m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    if (atom_data.size() != (size_t)m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    return SUCCESS;
+}
+
+MolReader::Status XTCReader::skip_timestep()
+{
+    return seek_timestep(m_current + 1);
+}
+
+MolReader::Status XTCReader::seek_timestep(size_t const frame)
+{
+    if (!m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    if (frame > m_index.size())
+    {
+        m_current = m_index.size();
+        return END;
+    }
+
+    count_skipped(m_current, frame);
+    m_current = frame;
+    return SUCCESS;
+}
+
+MolReader::Status XTCReader::read_timestep(Timestep& timestep)
+{
+    if (!m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    if (timestep.coords().cols() == 0 || timestep.is_view())
+    {
+        timestep = Timestep(m_num_atoms);
+    }
+    else if (timestep.coords().cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    if (m_current >= m_index.size())
+    {
+        return END;
+    }
+
+    m_buffer.resize(m_index.frame_size(m_current));
+    track_buffer(m_buffer.capacity());
+    m_read_ahead.access(m_index.offset(m_current), m_buffer.size());
+    {
+        StatsTimer timer(m_stats.io_time);
+        m_file.clear();
+        m_file.seekg(m_index.offset(m_current));
+        m_file.read(reinterpret_cast<char *>(m_buffer.data()), m_buffer.size());
+    }
+    if (!m_file)
+    {
+        return FAILED;
+    }
+    m_stats.bytes_read += m_buffer.size();
+
+    {
+        StatsTimer timer(m_stats.decode_time);
+        if (!read_frame(m_buffer.data(), m_buffer.size(), timestep))
+        {
+            return FAILED;
+        }
+    }
+
+    ++m_stats.frames_decoded;
+    ++m_current;
+    return SUCCESS;
+}
+
+size_t XTCReader::batch_size() const
+{
+    size_t const num_threads = decode_pool().size();
+    return (num_threads > 1) ? 2 * num_threads : 1;
+}
+
+MolReader::Status XTCReader::read_timesteps(std::vector<size_t> const& frames, std::vector<Timestep>& timesteps, size_t &num_read)
+{
+    num_read = 0;
+    if (!m_file.is_open())
+    {
+        return INVALID;
+    }
+
+    // Compressed frames are read sequentially, then decoded in parallel
+    Status status = SUCCESS;
+    size_t count = 0;
+    std::vector<size_t> starts;
+    m_buffer.clear();
+    for (; count < frames.size() && frames[count] < m_index.size(); ++count)
+    {
+        Timestep &timestep = timesteps[count];
+        if (timestep.coords().cols() == 0 || timestep.is_view())
+        {
+            timestep = Timestep(m_num_atoms);
+        }
+        else if (timestep.coords().cols() != m_num_atoms)
+        {
+            status = WRONG_ATOMS;
+            break;
+        }
+
+        size_t const start = m_buffer.size();
+        m_buffer.resize(start + m_index.frame_size(frames[count]));
+        m_read_ahead.access(m_index.offset(frames[count]), m_buffer.size() - start);
+        {
+            StatsTimer timer(m_stats.io_time);
+            m_file.clear();
+            m_file.seekg(m_index.offset(frames[count]));
+            m_file.read(reinterpret_cast<char *>(m_buffer.data() + start), m_buffer.size() - start);
+        }
+        if (!m_file)
+        {
+            m_buffer.resize(start);
+            status = FAILED;
+            break;
+        }
+        starts.push_back(start);
+        count_skipped(count ? frames[count - 1] + 1 : m_current, frames[count]);
+    }
+    starts.push_back(m_buffer.size());
+    m_stats.bytes_read += m_buffer.size();
+    track_buffer(m_buffer.capacity());
+
+    // Each task decodes a contiguous range of frames
+    StatsTimer timer(m_stats.decode_time);
+    ThreadPool &pool = decode_pool();
+    size_t const num_tasks = std::min(count, pool.size());
+    std::vector<std::future<void>> tasks;
+    std::vector<char> decoded(count, false);
+    for (size_t task = 0; task < num_tasks; ++task)
+    {
+        size_t const first = count * task / num_tasks;
+        size_t const last = count * (task + 1) / num_tasks;
+        tasks.push_back(pool.submit([this, &starts, &timesteps, &decoded, first, last]()
+        {
+            for (size_t i = first; i < last && read_frame(m_buffer.data() + starts[i], starts[i + 1] - starts[i], timesteps[i]); ++i)
+            {
+                decoded[i] = true;
+            }
+        }));
+    }
+    for (std::future<void> &task : tasks)
+    {
+        task.get();
+    }
+
+    // As with sequential reads, frames before the first failure are
+    // read, and the reader stays at the failed one
+    num_read = std::find(decoded.begin(), decoded.end(), false) - decoded.begin();
+    m_stats.frames_decoded += num_read;
+    if (num_read < count)
+    {
+        status = FAILED;
+    }
+
+    if (status != SUCCESS)
+    {
+        m_current = frames[num_read];
+    }
+    else if (count < frames.size())
+    {
+        m_current = m_index.size();
+    }
+    else if (count > 0)
+    {
+        m_current = frames.back() + 1;
+    }
+    return status;
+}
+
+bool XTCReader::frame_time(size_t const frame, double &time)
+{
+    if (!m_file.is_open() || frame >= m_index.size())
+    {
+        return false;
+    }
+
+    // Known from the frame headers read by the index
+    time = m_index.time(frame);
+    return true;
+}
+
+bool XTCReader::build_index()
+{
+    StatsTimer timer(m_stats.io_time);
+    m_file.clear();
+    m_file.seekg(0, std::ios::end);
+    uint64_t const file_size = m_file.tellg();
+    uint64_t offset = 0;
+    xtc::Header header;
+
+    // Only frame headers are read. Scanning stops at the
+    // first truncated or invalid frame.
+    m_index.clear();
+    m_buffer.resize(xtc::PREFIX_SIZE);
+    while (offset < file_size)
+    {
+        m_file.clear();
+        m_file.seekg(offset);
+        m_file.read(reinterpret_cast<char *>(m_buffer.data()), m_buffer.size());
+        size_t const num_read = m_file.gcount();
+        m_stats.bytes_read += num_read;
+        uint64_t const frame_size = xtc::frame_size(m_buffer.data(), num_read);
+
+        if (frame_size == 0
+            || offset + frame_size > file_size
+            || !xtc::read_header(m_buffer.data(), num_read, header)
+            || header.num_atoms != m_num_atoms)
+        {
+            break;
+        }
+
+        m_index.add_frame(offset, frame_size, header.time);
+        offset += frame_size;
+    }
+
+    return m_index.size();
+}
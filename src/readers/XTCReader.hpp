@@ -0,0 +1,53 @@
+#ifndef XTCREADER_HPP
+#define XTCREADER_HPP
+
+#include "MolReader.hpp"
+#include "FrameIndex.hpp"
+#include "ReadAhead.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace mol::internal {
+
+// Native reader for Gromacs' XTC trajectories. Frame offsets are
+// indexed on the first open, so skipping and seeking are O(1).
+// Batches of frames are decompressed in parallel.
+class XTCReader : public MolReader
+{
+public:
+    XTCReader();
+    ~XTCReader();
+    static bool can_read(std::string const &file_ext);
+    bool has_topology() const override;
+    bool has_trajectory() const override;
+    bool has_bonds() const override;
+    bool has_trajectory_metadata() const override;
+    bool can_seek() const override;
+    Status open(const std::string &file_name) override;
+    void close() override;
+    std::unique_ptr<MolData> read_atoms() override;
+    Status check_timestep_read(MolData& atom_data) override;
+    Status skip_timestep() override;
+    Status seek_timestep(size_t const frame) override;
+    Status read_timestep(Timestep& timestep) override;
+    bool frame_time(size_t const frame, double &time) override;
+    size_t batch_size() const override;
+    Status read_timesteps(std::vector<size_t> const& frames, std::vector<Timestep>& timesteps, size_t &num_read) override;
+    using MolReader::skip_timestep;
+    using MolReader::read_timestep;
+
+private:
+    bool build_index();
+
+    int m_num_atoms;
+    size_t m_current;
+    std::ifstream m_file;
+    FrameIndex m_index;
+    ReadAhead m_read_ahead;
+    std::vector<unsigned char> m_buffer;
+};
+
+} // namespace mol::internal
+
+#endif // XTCREADER_HPP
@@ -15,5 +15,9 @@ VMDPLUGIN_EXTERN int psfplugin_init();
 VMDPLUGIN_EXTERN int psfplugin_register(void *v, vmdplugin_register_cb cb);
 VMDPLUGIN_EXTERN int gromacsplugin_init();
 VMDPLUGIN_EXTERN int gromacsplugin_register(void *v, vmdplugin_register_cb cb);
+VMDPLUGIN_EXTERN int dcdplugin_init();
+VMDPLUGIN_EXTERN int dcdplugin_register(void *v, vmdplugin_register_cb cb);
+VMDPLUGIN_EXTERN int binposplugin_init();
+VMDPLUGIN_EXTERN int binposplugin_register(void *v, vmdplugin_register_cb cb);
 
 #endif // MOLFILE_H
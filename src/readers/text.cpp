@@ -0,0 +1,85 @@
+#include "text.hpp"
+#include "tools/ThreadPool.hpp"
+#include <charconv>
+#include <future>
+
+using namespace mol::internal;
+
+namespace {
+
+// Texts smaller than this are parsed by the calling thread
+size_t const PARALLEL_SIZE = 1 << 20;
+
+// Shared by all readers, so that loading several
+// files at once does not oversubscribe the CPUs.
+ThreadPool &parse_pool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+// Skips a plus sign, which from_chars does not accept
+std::string_view number(std::string_view chars)
+{
+    chars = text::trim(chars);
+    if (!chars.empty() && chars.front() == '+')
+    {
+        chars.remove_prefix(1);
+    }
+    return chars;
+}
+
+} // namespace
+
+std::string_view text::trim(std::string_view const chars)
+{
+    size_t const first = chars.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    size_t const last = chars.find_last_not_of(" \t\r\n");
+    return chars.substr(first, last - first + 1);
+}
+
+int text::to_int(std::string_view const chars)
+{
+    std::string_view const digits = number(chars);
+    int value = 0;
+    std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    return value;
+}
+
+float text::to_float(std::string_view const chars)
+{
+    std::string_view const digits = number(chars);
+    float value = 0;
+    std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    return value;
+}
+
+size_t text::chunk_count(size_t const size)
+{
+    return (size < PARALLEL_SIZE) ? 1 : parse_pool().size();
+}
+
+void text::run_chunks(size_t const num_chunks, std::function<void(size_t)> const& task)
+{
+    if (num_chunks == 1)
+    {
+        task(0);
+        return;
+    }
+
+    ThreadPool &pool = parse_pool();
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(num_chunks);
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+        tasks.push_back(pool.submit([&task, chunk]() { task(chunk); }));
+    }
+    for (std::future<void> &result : tasks)
+    {
+        result.get();
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef TEXT_HPP
+#define TEXT_HPP
+
+#include <string_view>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+namespace mol::internal::text {
+
+// Line starting at the given position, without its line break. The
+// position is moved to the start of the next line.
+inline std::string_view next_line(char const *&pos, char const *const end)
+{
+    char const *newline = static_cast<char const *>(std::memchr(pos, '\n', end - pos));
+    char const *line_end = newline ? newline : end;
+    std::string_view line(pos, line_end - pos);
+    pos = newline ? newline + 1 : end;
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+// Fixed-width column of a line, shorter or empty past its end
+inline std::string_view field(std::string_view const line, size_t const begin, size_t const size)
+{
+    return (begin < line.size()) ? line.substr(begin, size) : std::string_view();
+}
+
+std::string_view trim(std::string_view const chars);
+// Leading number of the characters, as atoi and atof do, or zero
+int to_int(std::string_view const chars);
+float to_float(std::string_view const chars);
+
+// Chunks to split the given number of bytes in
+size_t chunk_count(size_t const size);
+// Runs the task for each chunk, in parallel if there are several
+void run_chunks(size_t const num_chunks, std::function<void(size_t)> const& task);
+
+// Lines from begin to end are split into chunks at line boundaries,
+// one per thread for large texts, and parsed in parallel. Records
+// are the lines telling so, numbered in file order, and only the
+// first max_records ones are parsed. Returns the number of records
+// parsed.
+template <typename IsRecord, typename Parse>
+size_t parse_lines(char const *const begin, char const *const end, size_t const max_records, IsRecord const& is_record, Parse const& parse)
+{
+    size_t const num_chunks = chunk_count(end - begin);
+    std::vector<char const *> bounds { begin };
+    for (size_t i = 1; i < num_chunks; ++i)
+    {
+        char const *pos = std::max(bounds.back(), begin + (end - begin) * i / num_chunks);
+        if (pos > begin && pos[-1] != '\n')
+        {
+            next_line(pos, end);
+        }
+        bounds.push_back(pos);
+    }
+    bounds.push_back(end);
+
+    // Records are counted first, so that each chunk knows the
+    // index of its first one
+    std::vector<size_t> firsts(num_chunks + 1, 0);
+    run_chunks(num_chunks, [&](size_t const chunk)
+    {
+        size_t count = 0;
+        for (char const *pos = bounds[chunk]; pos < bounds[chunk + 1];)
+        {
+            count += is_record(next_line(pos, end));
+        }
+        firsts[chunk + 1] = count;
+    });
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+        firsts[chunk + 1] += firsts[chunk];
+    }
+
+    run_chunks(num_chunks, [&](size_t const chunk)
+    {
+        size_t index = firsts[chunk];
+        for (char const *pos = bounds[chunk]; pos < bounds[chunk + 1] && index < max_records;)
+        {
+            std::string_view const line = next_line(pos, end);
+            if (is_record(line))
+            {
+                parse(line, index++);
+            }
+        }
+    });
+
+    return std::min(firsts.back(), max_records);
+}
+
+} // namespace mol::internal::text
+
+#endif // TEXT_HPP
@@ -0,0 +1,191 @@
+#include "trr.hpp"
+#include <cstring>
+
+using namespace mol::internal;
+
+namespace {
+
+float const ANGS_PER_NM = 10;
+char const VERSION[] = "GMX_trn_file";
+size_t const VERSION_LENGTH = sizeof(VERSION) - 1;
+// Magic number, version string and 13 integers
+size_t const FIXED_SIZE = 24 + 13 * 4;
+
+// XDR data is big-endian
+uint32_t read_uint(unsigned char const *data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+double read_real(unsigned char const *data, bool const is_double)
+{
+    if (is_double)
+    {
+        uint64_t const bits = (uint64_t(read_uint(data)) << 32) | read_uint(data + 4);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    uint32_t const bits = read_uint(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void write_uint(std::vector<unsigned char> &data, uint32_t const value)
+{
+    data.push_back(value >> 24);
+    data.push_back(value >> 16);
+    data.push_back(value >> 8);
+    data.push_back(value);
+}
+
+void write_float(std::vector<unsigned char> &data, float const value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    write_uint(data, bits);
+}
+
+} // namespace
+
+bool trr::read_header(unsigned char const *data, size_t const size, Header &header)
+{
+    if (size < FIXED_SIZE
+        || read_uint(data) != MAGIC
+        || read_uint(data + 4) != VERSION_LENGTH + 1
+        || read_uint(data + 8) != VERSION_LENGTH
+        || std::memcmp(data + 12, VERSION, VERSION_LENGTH) != 0)
+    {
+        return false;
+    }
+
+    // Sizes of the input record, energies, box, virial, pressure,
+    // topology, symmetry, coordinates, velocities and forces
+    uint32_t sizes[10];
+    for (size_t i = 0; i < 10; ++i)
+    {
+        sizes[i] = read_uint(data + 24 + 4 * i);
+    }
+    int32_t const num_atoms = read_uint(data + 64);
+    header.num_atoms = num_atoms;
+    header.step = read_uint(data + 68);
+
+    // Unused records, which current versions never write
+    if (num_atoms <= 0 || sizes[0] || sizes[1] || sizes[5] || sizes[6])
+    {
+        return false;
+    }
+    header.box_size = sizes[2];
+    header.vir_size = sizes[3];
+    header.pres_size = sizes[4];
+    header.x_size = sizes[7];
+    header.v_size = sizes[8];
+    header.f_size = sizes[9];
+
+    // The precision is only known from the blocks' sizes
+    size_t real_size = 0;
+    if (header.box_size)
+    {
+        real_size = header.box_size / 9;
+    }
+    else if (header.x_size)
+    {
+        real_size = header.x_size / (3 * num_atoms);
+    }
+    else if (header.v_size)
+    {
+        real_size = header.v_size / (3 * num_atoms);
+    }
+    else if (header.f_size)
+    {
+        real_size = header.f_size / (3 * num_atoms);
+    }
+    if (real_size != sizeof(float) && real_size != sizeof(double))
+    {
+        return false;
+    }
+    header.is_double = real_size == sizeof(double);
+
+    size_t const vector_size = 3 * num_atoms * real_size;
+    if ((header.box_size && header.box_size != 9 * real_size)
+        || (header.x_size && header.x_size != vector_size)
+        || (header.v_size && header.v_size != vector_size)
+        || (header.f_size && header.f_size != vector_size))
+    {
+        return false;
+    }
+
+    // Time and lambda
+    header.header_size = FIXED_SIZE + 2 * real_size;
+    if (size < header.header_size)
+    {
+        return false;
+    }
+    header.time = read_real(data + FIXED_SIZE, header.is_double);
+
+    return true;
+}
+
+size_t trr::frame_size(Header const& header)
+{
+    return coords_end(header) + header.v_size + header.f_size;
+}
+
+size_t trr::coords_end(Header const& header)
+{
+    return header.header_size + header.box_size + header.vir_size + header.pres_size + header.x_size;
+}
+
+bool trr::read_coords(unsigned char const *data, Header const& header, float *box, float *coords)
+{
+    if (!header.x_size)
+    {
+        return false;
+    }
+
+    size_t const real_size = header.is_double ? sizeof(double) : sizeof(float);
+    unsigned char const *block = data + header.header_size;
+    for (size_t i = 0; i < 9; ++i)
+    {
+        box[i] = header.box_size ? read_real(block + real_size * i, header.is_double) * ANGS_PER_NM : 0;
+    }
+
+    block += header.box_size + header.vir_size + header.pres_size;
+    for (size_t i = 0; i < 3 * (size_t)header.num_atoms; ++i)
+    {
+        coords[i] = read_real(block + real_size * i, header.is_double) * ANGS_PER_NM;
+    }
+
+    return true;
+}
+
+void trr::write_frame(Header const& header, float const *box, float const *coords, std::vector<unsigned char> &data)
+{
+    size_t const num_atoms = header.num_atoms;
+    write_uint(data, MAGIC);
+    write_uint(data, VERSION_LENGTH + 1);
+    write_uint(data, VERSION_LENGTH);
+    data.insert(data.end(), VERSION, VERSION + VERSION_LENGTH);
+
+    uint32_t const sizes[10] = {0, 0, 9 * sizeof(float), 0, 0, 0, 0, uint32_t(3 * num_atoms * sizeof(float)), 0, 0};
+    for (uint32_t const size : sizes)
+    {
+        write_uint(data, size);
+    }
+    write_uint(data, num_atoms);
+    write_uint(data, header.step);
+    write_uint(data, 0);
+    write_float(data, header.time);
+    write_float(data, 0);
+
+    for (size_t i = 0; i < 9; ++i)
+    {
+        write_float(data, box[i] / ANGS_PER_NM);
+    }
+    for (size_t i = 0; i < 3 * num_atoms; ++i)
+    {
+        write_float(data, coords[i] / ANGS_PER_NM);
+    }
+}
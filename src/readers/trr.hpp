@@ -0,0 +1,55 @@
+#ifndef TRR_HPP
+#define TRR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Native coding of Gromacs' TRR frames from and to memory buffers.
+namespace mol::internal::trr {
+
+int const MAGIC = 1993;
+
+// Leading bytes holding the header of any frame
+size_t const PREFIX_SIZE = 92;
+
+struct Header
+{
+    int num_atoms;
+    int step;
+    double time;
+    // Frames are single or double precision
+    bool is_double;
+    // Sizes in bytes of the header and of the data blocks,
+    // which are stored in this order
+    size_t header_size;
+    size_t box_size;
+    size_t vir_size;
+    size_t pres_size;
+    size_t x_size;
+    size_t v_size;
+    size_t f_size;
+};
+
+// Parses the frame header. Returns false for invalid data.
+bool read_header(unsigned char const *data, size_t const size, Header &header);
+
+// Total size in bytes of the frame
+size_t frame_size(Header const& header);
+
+// Bytes up to the end of the coordinates, which is all that
+// is needed to read them
+size_t coords_end(Header const& header);
+
+// Reads the box vectors, in angstroms, and the xyz-ordered coordinates,
+// also in angstroms, from data starting at the frame's header.
+// Returns false if the frame has no coordinates.
+bool read_coords(unsigned char const *data, Header const& header, float *box, float *coords);
+
+// Appends a single precision frame with box vectors and coordinates,
+// in angstroms
+void write_frame(Header const& header, float const *box, float const *coords, std::vector<unsigned char> &data);
+
+} // namespace mol::internal::trr
+
+#endif // TRR_HPP
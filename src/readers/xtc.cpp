@@ -0,0 +1,766 @@
+#include "xtc.hpp"
+#include <cstring>
+#include <cmath>
+#include <cstdlib>
+#include <climits>
+#include <utility>
+
+using namespace mol::internal;
+
+/*
+ * Implementation of the 3dfcoord (de)compression algorithm, written by
+ * Frans van Hoesel as part of the Europort project in 1995. Adapted
+ * from the molfile plugin and xdrfile versions to work on memory
+ * buffers.
+ */
+namespace {
+
+float const ANGS_PER_NM = 10;
+size_t const HEADER_SIZE = 52;
+size_t const SMALL_SIZE_ATOMS = 9;
+
+int const MAGICINTS[] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 10, 12, 16, 20, 25, 32, 40, 50, 64,
+    80, 101, 128, 161, 203, 256, 322, 406, 512, 645, 812, 1024, 1290,
+    1625, 2048, 2580, 3250, 4096, 5060, 6501, 8192, 10321, 13003, 16384,
+    20642, 26007, 32768, 41285, 52015, 65536, 82570, 104031, 131072,
+    165140, 208063, 262144, 330280, 416127, 524287, 660561, 832255,
+    1048576, 1321122, 1664510, 2097152, 2642245, 3329021, 4194304,
+    5284491, 6658042, 8388607, 10568983, 13316085, 16777216
+};
+int const FIRSTIDX = 9;
+int const LASTIDX = sizeof(MAGICINTS) / sizeof(*MAGICINTS);
+
+// XDR data is big-endian
+int32_t read_int(unsigned char const *data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+float read_float(unsigned char const *data)
+{
+    int32_t const value = read_int(data);
+    float result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+void write_int(std::vector<unsigned char> &data, int32_t const value)
+{
+    uint32_t const bits = value;
+    data.push_back(bits >> 24);
+    data.push_back(bits >> 16);
+    data.push_back(bits >> 8);
+    data.push_back(bits);
+}
+
+void write_float(std::vector<unsigned char> &data, float const value)
+{
+    int32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    write_int(data, bits);
+}
+
+class BitReader
+{
+public:
+    BitReader(unsigned char const *data, size_t const size)
+    : m_data{data},
+      m_size{size},
+      m_count{0},
+      m_lastbits{0},
+      m_lastbyte{0},
+      m_overflow{false}
+    {}
+
+    bool overflow() const
+    {
+        return m_overflow;
+    }
+
+    int bits(int num_bits)
+    {
+        int const mask = (1 << num_bits) - 1;
+        int num = 0;
+
+        while (num_bits >= 8)
+        {
+            m_lastbyte = (m_lastbyte << 8) | next();
+            num |= (m_lastbyte >> m_lastbits) << (num_bits - 8);
+            num_bits -= 8;
+        }
+        if (num_bits > 0)
+        {
+            if (m_lastbits < (unsigned int)num_bits)
+            {
+                m_lastbits += 8;
+                m_lastbyte = (m_lastbyte << 8) | next();
+            }
+            m_lastbits -= num_bits;
+            num |= (m_lastbyte >> m_lastbits) & ((1 << num_bits) - 1);
+        }
+
+        return num & mask;
+    }
+
+    void ints(int const num_ints, int num_bits, unsigned int const *sizes, int *nums)
+    {
+        int bytes[32];
+        int num_bytes = 0;
+
+        bytes[1] = bytes[2] = bytes[3] = 0;
+        while (num_bits > 8)
+        {
+            bytes[num_bytes++] = bits(8);
+            num_bits -= 8;
+        }
+        if (num_bits > 0)
+        {
+            bytes[num_bytes++] = bits(num_bits);
+        }
+
+        for (int i = num_ints - 1; i > 0; i--)
+        {
+            unsigned int num = 0;
+            for (int j = num_bytes - 1; j >= 0; j--)
+            {
+                num = (num << 8) | bytes[j];
+                unsigned int const p = num / sizes[i];
+                bytes[j] = p;
+                num = num - p * sizes[i];
+            }
+            nums[i] = num;
+        }
+        nums[0] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
+    }
+
+private:
+    unsigned int next()
+    {
+        if (m_count >= m_size)
+        {
+            m_overflow = true;
+            return 0;
+        }
+        return m_data[m_count++];
+    }
+
+    unsigned char const *m_data;
+    size_t m_size;
+    size_t m_count;
+    unsigned int m_lastbits;
+    unsigned int m_lastbyte;
+    bool m_overflow;
+};
+
+class BitWriter
+{
+public:
+    BitWriter()
+    : m_lastbits{0},
+      m_lastbyte{0}
+    {}
+
+    // Bytes written, including the last partial one
+    std::vector<unsigned char> const& data() const
+    {
+        return m_data;
+    }
+
+    void bits(int num_bits, unsigned int const num)
+    {
+        while (num_bits >= 8)
+        {
+            m_lastbyte = (m_lastbyte << 8) | (num >> (num_bits - 8));
+            m_data.push_back(m_lastbyte >> m_lastbits);
+            num_bits -= 8;
+        }
+        if (num_bits > 0)
+        {
+            m_lastbyte = (m_lastbyte << num_bits) | num;
+            m_lastbits += num_bits;
+            if (m_lastbits >= 8)
+            {
+                m_lastbits -= 8;
+                m_data.push_back(m_lastbyte >> m_lastbits);
+            }
+        }
+    }
+
+    void ints(int const num_ints, int const num_bits, unsigned int const *sizes, unsigned int const *nums)
+    {
+        unsigned int bytes[32];
+        unsigned int num_bytes = 0;
+        unsigned int tmp = nums[0];
+
+        do
+        {
+            bytes[num_bytes++] = tmp & 0xff;
+            tmp >>= 8;
+        } while (tmp != 0);
+
+        for (int i = 1; i < num_ints; i++)
+        {
+            tmp = nums[i];
+            unsigned int byte_count;
+            for (byte_count = 0; byte_count < num_bytes; byte_count++)
+            {
+                tmp = bytes[byte_count] * sizes[i] + tmp;
+                bytes[byte_count] = tmp & 0xff;
+                tmp >>= 8;
+            }
+            while (tmp != 0)
+            {
+                bytes[byte_count++] = tmp & 0xff;
+                tmp >>= 8;
+            }
+            num_bytes = byte_count;
+        }
+
+        if ((unsigned int)num_bits >= num_bytes * 8)
+        {
+            for (unsigned int i = 0; i < num_bytes; i++)
+            {
+                bits(8, bytes[i]);
+            }
+            bits(num_bits - num_bytes * 8, 0);
+        }
+        else
+        {
+            for (unsigned int i = 0; i < num_bytes - 1; i++)
+            {
+                bits(8, bytes[i]);
+            }
+            bits(num_bits - (num_bytes - 1) * 8, bytes[num_bytes - 1]);
+        }
+    }
+
+    // Pads the last partial byte with zeros
+    void flush()
+    {
+        if (m_lastbits > 0)
+        {
+            m_data.push_back(m_lastbyte << (8 - m_lastbits));
+            m_lastbits = 0;
+        }
+    }
+
+private:
+    std::vector<unsigned char> m_data;
+    unsigned int m_lastbits;
+    unsigned int m_lastbyte;
+};
+
+int sizeofint(unsigned int const size)
+{
+    unsigned int num = 1;
+    int num_bits = 0;
+
+    while (size >= num && num_bits < 32)
+    {
+        num_bits++;
+        num <<= 1;
+    }
+    return num_bits;
+}
+
+int sizeofints(int const num_ints, unsigned int const *sizes)
+{
+    unsigned int bytes[32];
+    unsigned int num_bytes = 1;
+    int num_bits = 0;
+
+    bytes[0] = 1;
+    for (int i = 0; i < num_ints; i++)
+    {
+        unsigned int tmp = 0;
+        unsigned int byte_count;
+        for (byte_count = 0; byte_count < num_bytes; byte_count++)
+        {
+            tmp = bytes[byte_count] * sizes[i] + tmp;
+            bytes[byte_count] = tmp & 0xff;
+            tmp >>= 8;
+        }
+        while (tmp != 0)
+        {
+            bytes[byte_count++] = tmp & 0xff;
+            tmp >>= 8;
+        }
+        num_bytes = byte_count;
+    }
+
+    unsigned int num = 1;
+    num_bytes--;
+    while (bytes[num_bytes] >= num)
+    {
+        num_bits++;
+        num *= 2;
+    }
+    return num_bits + num_bytes * 8;
+}
+
+} // namespace
+
+bool xtc::read_header(unsigned char const *data, size_t const size, Header &header)
+{
+    if (size < HEADER_SIZE || read_int(data) != MAGIC)
+    {
+        return false;
+    }
+
+    header.num_atoms = read_int(data + 4);
+    header.step = read_int(data + 8);
+    header.time = read_float(data + 12);
+    for (size_t i = 0; i < 9; ++i)
+    {
+        header.box[i] = read_float(data + 16 + 4 * i);
+    }
+
+    return header.num_atoms > 0;
+}
+
+size_t xtc::frame_size(unsigned char const *prefix, size_t const size)
+{
+    Header header;
+    if (!read_header(prefix, size, header))
+    {
+        return 0;
+    }
+
+    size_t const num_atoms = header.num_atoms;
+    if (num_atoms <= SMALL_SIZE_ATOMS)
+    {
+        return HEADER_SIZE + 4 + 12 * num_atoms;
+    }
+    if (size < PREFIX_SIZE)
+    {
+        return 0;
+    }
+
+    int32_t const num_bytes = read_int(prefix + PREFIX_SIZE - 4);
+    if (num_bytes < 0)
+    {
+        return 0;
+    }
+    return PREFIX_SIZE + ((num_bytes + 3) / 4) * 4;
+}
+
+bool xtc::read_coords(unsigned char const *data, size_t const size, float *coords)
+{
+    Header header;
+    if (!read_header(data, size, header) || size < HEADER_SIZE + 4)
+    {
+        return false;
+    }
+
+    int const num_atoms = read_int(data + HEADER_SIZE);
+    if (num_atoms != header.num_atoms)
+    {
+        return false;
+    }
+
+    // Small systems are not compressed
+    if ((size_t)num_atoms <= SMALL_SIZE_ATOMS)
+    {
+        if (size < HEADER_SIZE + 4 + 12 * num_atoms)
+        {
+            return false;
+        }
+        for (int i = 0; i < 3 * num_atoms; ++i)
+        {
+            coords[i] = read_float(data + HEADER_SIZE + 4 + 4 * i);
+            coords[i] *= ANGS_PER_NM;
+        }
+        return true;
+    }
+
+    size_t const frame_bytes = frame_size(data, size);
+    if (frame_bytes == 0 || frame_bytes > size)
+    {
+        return false;
+    }
+
+    unsigned char const *body = data + HEADER_SIZE + 4;
+    float const precision = read_float(body);
+    int minint[3], maxint[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        minint[i] = read_int(body + 4 + 4 * i);
+        maxint[i] = read_int(body + 16 + 4 * i);
+    }
+    int smallidx = read_int(body + 28);
+    if (smallidx < FIRSTIDX || smallidx >= LASTIDX)
+    {
+        return false;
+    }
+
+    unsigned int sizeint[3], sizesmall[3], bitsizeint[3] = {0, 0, 0};
+    unsigned int bitsize = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        sizeint[i] = maxint[i] - minint[i] + 1;
+    }
+
+    // Check if one of the sizes is too big to be multiplied
+    if ((sizeint[0] | sizeint[1] | sizeint[2]) > 0xffffff)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            bitsizeint[i] = sizeofint(sizeint[i]);
+        }
+    }
+    else
+    {
+        bitsize = sizeofints(3, sizeint);
+    }
+
+    int smaller = MAGICINTS[(FIRSTIDX > smallidx - 1) ? FIRSTIDX : smallidx - 1] / 2;
+    int small = MAGICINTS[smallidx] / 2;
+    sizesmall[0] = sizesmall[1] = sizesmall[2] = MAGICINTS[smallidx];
+
+    BitReader reader(data + PREFIX_SIZE, frame_bytes - PREFIX_SIZE);
+    float const inv_precision = 1.0f / precision;
+    float *out = coords;
+    float *const out_end = coords + 3 * num_atoms;
+    int thiscoord[3], prevcoord[3];
+    int run = 0;
+    int i = 0;
+
+    auto const write = [&out, out_end, inv_precision](int const *coord) {
+        if (out + 3 > out_end)
+        {
+            return false;
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            float value = coord[k] * inv_precision;
+            value *= ANGS_PER_NM;
+            *out++ = value;
+        }
+        return true;
+    };
+
+    while (i < num_atoms)
+    {
+        if (bitsize == 0)
+        {
+            thiscoord[0] = reader.bits(bitsizeint[0]);
+            thiscoord[1] = reader.bits(bitsizeint[1]);
+            thiscoord[2] = reader.bits(bitsizeint[2]);
+        }
+        else
+        {
+            reader.ints(3, bitsize, sizeint, thiscoord);
+        }
+
+        i++;
+        for (int k = 0; k < 3; ++k)
+        {
+            thiscoord[k] += minint[k];
+            prevcoord[k] = thiscoord[k];
+        }
+
+        int const flag = reader.bits(1);
+        int is_smaller = 0;
+        if (flag == 1)
+        {
+            run = reader.bits(5);
+            is_smaller = run % 3;
+            run -= is_smaller;
+            is_smaller--;
+        }
+
+        if (run > 0)
+        {
+            if (sizesmall[0] == 0)
+            {
+                // Corrupted data
+                return false;
+            }
+
+            for (int k = 0; k < run; k += 3)
+            {
+                reader.ints(3, smallidx, sizesmall, thiscoord);
+                i++;
+                for (int l = 0; l < 3; ++l)
+                {
+                    thiscoord[l] += prevcoord[l] - small;
+                }
+
+                if (k == 0)
+                {
+                    // Interchange first with second atom for better
+                    // compression of water molecules
+                    for (int l = 0; l < 3; ++l)
+                    {
+                        std::swap(thiscoord[l], prevcoord[l]);
+                    }
+                    if (!write(prevcoord))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    for (int l = 0; l < 3; ++l)
+                    {
+                        prevcoord[l] = thiscoord[l];
+                    }
+                }
+
+                if (!write(thiscoord))
+                {
+                    return false;
+                }
+            }
+        }
+        else if (!write(thiscoord))
+        {
+            return false;
+        }
+
+        smallidx += is_smaller;
+        if (smallidx < 0 || smallidx >= LASTIDX)
+        {
+            return false;
+        }
+        if (is_smaller < 0)
+        {
+            small = smaller;
+            smaller = (smallidx > FIRSTIDX) ? MAGICINTS[smallidx - 1] / 2 : 0;
+        }
+        else if (is_smaller > 0)
+        {
+            smaller = small;
+            small = MAGICINTS[smallidx] / 2;
+        }
+        sizesmall[0] = sizesmall[1] = sizesmall[2] = MAGICINTS[smallidx];
+    }
+
+    return !reader.overflow() && out == out_end;
+}
+
+bool xtc::write_frame(Header const& header, float const *coords, float const precision, std::vector<unsigned char> &data)
+{
+    int const num_atoms = header.num_atoms;
+    write_int(data, MAGIC);
+    write_int(data, num_atoms);
+    write_int(data, header.step);
+    write_float(data, header.time);
+    for (size_t i = 0; i < 9; ++i)
+    {
+        write_float(data, header.box[i]);
+    }
+    write_int(data, num_atoms);
+
+    // Small systems are not compressed
+    if ((size_t)num_atoms <= SMALL_SIZE_ATOMS)
+    {
+        for (int i = 0; i < 3 * num_atoms; ++i)
+        {
+            write_float(data, coords[i] / ANGS_PER_NM);
+        }
+        return true;
+    }
+
+    // Integer coordinates and their ranges
+    std::vector<int> values(3 * num_atoms);
+    int minint[3] = {INT_MAX, INT_MAX, INT_MAX};
+    int maxint[3] = {INT_MIN, INT_MIN, INT_MIN};
+    int mindiff = INT_MAX;
+    for (int i = 0; i < num_atoms; ++i)
+    {
+        int diff = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            float const value = std::round(coords[3 * i + k] / ANGS_PER_NM * precision);
+            if (!(std::abs(value) < INT_MAX / 2))
+            {
+                return false;
+            }
+            int const lint = value;
+            minint[k] = std::min(minint[k], lint);
+            maxint[k] = std::max(maxint[k], lint);
+            values[3 * i + k] = lint;
+            if (i > 0)
+            {
+                diff += std::abs(lint - values[3 * (i - 1) + k]);
+            }
+        }
+        if (i > 0 && diff < mindiff)
+        {
+            mindiff = diff;
+        }
+    }
+
+    unsigned int sizeint[3], sizesmall[3], bitsizeint[3] = {0, 0, 0};
+    unsigned int bitsize = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+        sizeint[k] = maxint[k] - minint[k] + 1;
+    }
+    if ((sizeint[0] | sizeint[1] | sizeint[2]) > 0xffffff)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            bitsizeint[k] = sizeofint(sizeint[k]);
+        }
+    }
+    else
+    {
+        bitsize = sizeofints(3, sizeint);
+    }
+
+    int smallidx = FIRSTIDX;
+    while (smallidx < LASTIDX && MAGICINTS[smallidx] < mindiff)
+    {
+        smallidx++;
+    }
+
+    write_float(data, precision);
+    for (int k = 0; k < 3; ++k)
+    {
+        write_int(data, minint[k]);
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        write_int(data, maxint[k]);
+    }
+    write_int(data, smallidx);
+
+    int const maxidx = std::min(LASTIDX - 1, smallidx + 8);
+    int const minidx = maxidx - 8;
+    int smaller = MAGICINTS[std::max(FIRSTIDX, smallidx - 1)] / 2;
+    int small = MAGICINTS[smallidx] / 2;
+    int const larger = MAGICINTS[maxidx] / 2;
+    sizesmall[0] = sizesmall[1] = sizesmall[2] = MAGICINTS[smallidx];
+
+    BitWriter writer;
+    unsigned int tmpcoord[30];
+    int prevcoord[3] = {0, 0, 0};
+    int prevrun = -1;
+    int i = 0;
+
+    auto const is_close = [](int const *coord1, int const *coord2, int const limit) {
+        return std::abs(coord1[0] - coord2[0]) < limit
+            && std::abs(coord1[1] - coord2[1]) < limit
+            && std::abs(coord1[2] - coord2[2]) < limit;
+    };
+
+    while (i < num_atoms)
+    {
+        int *thiscoord = values.data() + 3 * i;
+        int is_smaller = 0;
+        if (smallidx < maxidx && i >= 1 && is_close(thiscoord, prevcoord, larger))
+        {
+            is_smaller = 1;
+        }
+        else if (smallidx > minidx)
+        {
+            is_smaller = -1;
+        }
+
+        bool is_small = false;
+        if (i + 1 < num_atoms && is_close(thiscoord, thiscoord + 3, small))
+        {
+            // Interchange first with second atom for better
+            // compression of water molecules
+            for (int k = 0; k < 3; ++k)
+            {
+                std::swap(thiscoord[k], thiscoord[k + 3]);
+            }
+            is_small = true;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            tmpcoord[k] = thiscoord[k] - minint[k];
+        }
+        if (bitsize == 0)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                writer.bits(bitsizeint[k], tmpcoord[k]);
+            }
+        }
+        else
+        {
+            writer.ints(3, bitsize, sizeint, tmpcoord);
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            prevcoord[k] = thiscoord[k];
+        }
+        thiscoord += 3;
+        i++;
+
+        int run = 0;
+        if (!is_small && is_smaller == -1)
+        {
+            is_smaller = 0;
+        }
+        while (is_small && run < 8 * 3)
+        {
+            int sum = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                int const diff = thiscoord[k] - prevcoord[k];
+                sum += diff * diff;
+            }
+            if (is_smaller == -1 && sum >= smaller * smaller)
+            {
+                is_smaller = 0;
+            }
+
+            for (int k = 0; k < 3; ++k)
+            {
+                tmpcoord[run++] = thiscoord[k] - prevcoord[k] + small;
+                prevcoord[k] = thiscoord[k];
+            }
+
+            thiscoord += 3;
+            i++;
+            is_small = i < num_atoms && is_close(thiscoord, prevcoord, small);
+        }
+
+        if (run != prevrun || is_smaller != 0)
+        {
+            // Run length changed
+            prevrun = run;
+            writer.bits(1, 1);
+            writer.bits(5, run + is_smaller + 1);
+        }
+        else
+        {
+            writer.bits(1, 0);
+        }
+        for (int k = 0; k < run; k += 3)
+        {
+            writer.ints(3, smallidx, sizesmall, tmpcoord + k);
+        }
+
+        if (is_smaller != 0)
+        {
+            smallidx += is_smaller;
+            if (is_smaller < 0)
+            {
+                small = smaller;
+                smaller = MAGICINTS[smallidx - 1] / 2;
+            }
+            else
+            {
+                smaller = small;
+                small = MAGICINTS[smallidx] / 2;
+            }
+            sizesmall[0] = sizesmall[1] = sizesmall[2] = MAGICINTS[smallidx];
+        }
+    }
+
+    // Opaque data is padded to 4 bytes
+    writer.flush();
+    std::vector<unsigned char> const& bytes = writer.data();
+    write_int(data, bytes.size());
+    data.insert(data.end(), bytes.begin(), bytes.end());
+    data.resize(data.size() + (4 - bytes.size() % 4) % 4, 0);
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef XTC_HPP
+#define XTC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Native coding of Gromacs' XTC frames from and to memory buffers.
+namespace mol::internal::xtc {
+
+int const MAGIC = 1995;
+
+// Default precision of Gromacs' writers, in 1/nm
+float const DEFAULT_PRECISION = 1000;
+
+// Leading bytes needed to find out the size of a frame
+size_t const PREFIX_SIZE = 92;
+
+struct Header
+{
+    int num_atoms;
+    int step;
+    float time;
+    // Box vectors, in nanometers
+    float box[9];
+};
+
+// Parses the frame header. Returns false for invalid data.
+bool read_header(unsigned char const *data, size_t const size, Header &header);
+
+// Total size in bytes of the frame starting with the given prefix, which
+// must hold at least PREFIX_SIZE bytes (or all the frame, for
+// systems with up to 9 atoms). Returns 0 for invalid frames.
+size_t frame_size(unsigned char const *prefix, size_t const size);
+
+// Decompresses a complete frame into xyz-ordered coordinates, in angstroms.
+bool read_coords(unsigned char const *data, size_t const size, float *coords);
+
+// Appends a frame with the header's number of atoms, compressed at the
+// given precision. Coordinates are xyz-ordered and in angstroms.
+// Returns false if they do not fit the precision.
+bool write_frame(Header const& header, float const *coords, float const precision, std::vector<unsigned char> &data);
+
+} // namespace mol::internal::xtc
+
+#endif // XTC_HPP
@@ -67,6 +67,11 @@ public:
         return std::views::keys(m_adjacency);
     }
 
+    auto const edges() const
+    {
+        return std::views::all(m_edges);
+    }
+
     auto edges(Node const &node)
     {
         return std::views::values(m_adjacency.at(node)) | std::views::transform([](auto &it){return *it;});
@@ -2,8 +2,12 @@
 #define SPATIALSEARCH_HPP
 
 #include <molpp/MolppCore.hpp>
+#include <molpp/UnitCell.hpp>
 #include <vector>
+#include <array>
+#include <limits>
 #include <utility>
+#include <algorithm>
 #include <cstdlib>
 
 namespace mol::internal {
@@ -26,16 +30,42 @@ public:
     SpatialSearch &operator=(SpatialSearch &&other) = delete;
     SpatialSearch(T const &points, float const cell_size)
     : m_cell_size(cell_size),
-      m_points{points}
+      m_points{points},
+      m_periodic{false}
     {
         update();
     }
 
+    // Periodic search with minimum-image distances. Non-periodic
+    // cells, and boxes narrower than twice the cell size, fall
+    // back to the regular search.
+    // Note: distances must be lower than half the smallest
+    // width of the box.
+    SpatialSearch(T const &points, float const cell_size, UnitCell const &cell)
+    : m_cell_size(cell_size),
+      m_points{points},
+      m_periodic{cell.is_periodic()}
+    {
+        if (m_periodic)
+        {
+            update_periodic(cell);
+        }
+        else
+        {
+            update();
+        }
+    }
+
     // Note: for optimal results, distance should be lower than
     // the cells' sizes.
     // Note: returned distance is squared.
     std::vector<std::tuple<index_t, index_t, float>> pairs(float const distance) const
     {
+        if (m_periodic)
+        {
+            return periodic_pairs(distance);
+        }
+
         index_t const num_layers = floor(distance / m_cell_size) + 1;
         float const distance2 = distance * distance;
         std::vector<std::tuple<index_t, index_t, float>> pairs_list;
@@ -80,6 +110,11 @@ public:
     // the cells' sizes.
     std::vector<index_t> query(index_t const query, float const distance) const
     {
+        if (m_periodic)
+        {
+            return periodic_query(query, distance);
+        }
+
         float const distance2 = distance * distance;
         index_t const num_layers = floor(distance / m_cell_size) + 1;
         Point3 point = m_points.col(query);
@@ -190,6 +225,176 @@ private:
         }
     }
 
+    void update_periodic(UnitCell const &cell)
+    {
+        // The grid is built on fractional coordinates, so
+        // that cells wrap around the box faces
+        m_box = cell.vectors();
+        m_inv_box = m_box.inverse();
+        m_orthorhombic = cell.is_orthorhombic();
+
+        float const volume = std::abs(m_box.determinant());
+        for (int i = 0; i < 3; i++)
+        {
+            m_widths(i) = volume / m_box.col((i + 1) % 3).cross(m_box.col((i + 2) % 3)).norm();
+            m_grid_size(i) = std::clamp<index_t>(floor(m_widths(i) / m_cell_size), 1, 100);
+        }
+        if (m_widths.minCoeff() < 2 * m_cell_size)
+        {
+            // Minimum images would be ambiguous
+            m_periodic = false;
+            update();
+            return;
+        }
+        m_strides = {1, m_grid_size(0), m_grid_size(0) * m_grid_size(1)};
+        m_cells.assign(m_grid_size.prod(), cell_t());
+
+        for (index_t i = 0; i < m_points.cols(); i++)
+        {
+            m_cells[m_strides * periodic_index(m_points.col(i))].push_back(i);
+        }
+    }
+
+    cell_index_t periodic_index(Point3 const &point) const
+    {
+        Point3 fractional = m_inv_box * point;
+        fractional -= fractional.array().floor().matrix();
+        cell_index_t const index = (fractional.array() * m_grid_size.cast<float>().array()).floor().cast<index_t>();
+        return index.cwiseMax(cell_index_t{0, 0, 0}).cwiseMin(m_grid_size - cell_index_t{1, 1, 1});
+    }
+
+    // Each neighbor cell is listed once, even if the
+    // search wraps around the whole box
+    std::vector<size_t> periodic_neighbors(cell_index_t const &index, float const distance) const
+    {
+        std::array<std::vector<index_t>, 3> axes;
+        for (int i = 0; i < 3; i++)
+        {
+            index_t const size = m_grid_size(i);
+            index_t const num_layers = ceil(distance * size / m_widths(i));
+            if (2 * num_layers + 1 >= size)
+            {
+                for (index_t cell = 0; cell < size; cell++)
+                {
+                    axes[i].push_back(cell);
+                }
+            }
+            else
+            {
+                for (index_t diff = -num_layers; diff <= num_layers; diff++)
+                {
+                    axes[i].push_back(((index(i) + diff) % size + size) % size);
+                }
+            }
+        }
+
+        std::vector<size_t> neighbors;
+        for (index_t const cell_z : axes[2])
+        for (index_t const cell_y : axes[1])
+        for (index_t const cell_x : axes[0])
+        {
+        {
+        {
+            neighbors.push_back(m_strides * cell_index_t{cell_x, cell_y, cell_z});
+        }
+        }
+        }
+
+        return neighbors;
+    }
+
+    float periodic_distance2(Point3 const &point1, Point3 const &point2) const
+    {
+        Point3 fractional = m_inv_box * (point2 - point1);
+        fractional -= fractional.array().round().matrix();
+        Point3 const diff = m_box * fractional;
+        if (m_orthorhombic)
+        {
+            return diff.squaredNorm();
+        }
+
+        // Rounding is not enough for skewed boxes
+        float distance2 = std::numeric_limits<float>::max();
+        for (int z = -1; z <= 1; z++)
+        for (int y = -1; y <= 1; y++)
+        for (int x = -1; x <= 1; x++)
+        {
+        {
+        {
+            Point3 const shift{float(x), float(y), float(z)};
+            distance2 = std::min(distance2, (diff + m_box * shift).squaredNorm());
+        }
+        }
+        }
+
+        return distance2;
+    }
+
+    std::vector<std::tuple<index_t, index_t, float>> periodic_pairs(float const distance) const
+    {
+        float const distance2 = distance * distance;
+        std::vector<std::tuple<index_t, index_t, float>> pairs_list;
+
+        for (index_t cell_z = 0; cell_z < m_grid_size(2); cell_z++)
+        for (index_t cell_y = 0; cell_y < m_grid_size(1); cell_y++)
+        for (index_t cell_x = 0; cell_x < m_grid_size(0); cell_x++)
+        {
+        {
+        {
+            cell_index_t const current_index{cell_x, cell_y, cell_z};
+            cell_t const &current_data = m_cells[m_strides * current_index];
+            if (current_data.empty())
+            {
+                continue;
+            }
+
+            for (size_t const offset : periodic_neighbors(current_index, distance))
+            {
+                for (index_t const i : current_data)
+                for (index_t const j : m_cells[offset])
+                {
+                {
+                    if (i <= j)
+                    {
+                        // Avoid duplicates
+                        continue;
+                    }
+
+                    float const pair_distance = periodic_distance2(m_points.col(i), m_points.col(j));
+                    if (pair_distance <= distance2)
+                    {
+                        pairs_list.push_back(std::tuple(i, j, pair_distance));
+                    }
+                }
+                }
+            }
+        }
+        }
+        }
+
+        return pairs_list;
+    }
+
+    std::vector<index_t> periodic_query(index_t const query, float const distance) const
+    {
+        float const distance2 = distance * distance;
+        Point3 const point = m_points.col(query);
+        std::vector<index_t> result;
+
+        for (size_t const offset : periodic_neighbors(periodic_index(point), distance))
+        {
+            for (index_t const index : m_cells[offset])
+            {
+                if (periodic_distance2(point, m_points.col(index)) <= distance2)
+                {
+                    result.push_back(index);
+                }
+            }
+        }
+
+        return result;
+    }
+
     float m_cell_size;
     Point3 m_origin;
     cell_index_t m_grid_size;
@@ -197,6 +402,11 @@ private:
     stride_t m_strides;
     T const &m_points;
     std::vector<cell_t> m_cells;
+    bool m_periodic;
+    bool m_orthorhombic;
+    Box3 m_box;
+    Box3 m_inv_box;
+    Point3 m_widths;
 };
 
 } // namespace mol::internal
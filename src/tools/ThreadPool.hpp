@@ -0,0 +1,98 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+namespace mol::internal {
+
+// Fixed set of worker threads running queued tasks in order.
+// Destroying the pool waits for all pending tasks.
+class ThreadPool {
+public:
+    ThreadPool(ThreadPool const &other) = delete;
+    ThreadPool &operator=(ThreadPool const &other) = delete;
+    // Zero threads means one per hardware thread
+    ThreadPool(size_t num_threads = 0)
+    : m_stop{false}
+    {
+        if (num_threads == 0)
+        {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        m_workers.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; i++)
+        {
+            m_workers.emplace_back([this] { run(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+
+        for (std::thread &worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t size() const
+    {
+        return m_workers.size();
+    }
+
+    // Exceptions thrown by the task are rethrown by the future
+    template <typename Function>
+    std::future<void> submit(Function &&function)
+    {
+        std::packaged_task<void()> task(std::forward<Function>(function));
+        std::future<void> result = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_cond.notify_one();
+        return result;
+    }
+
+private:
+    void run()
+    {
+        while (true)
+        {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    bool m_stop;
+    std::vector<std::thread> m_workers;
+    std::deque<std::packaged_task<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+} // namespace mol::internal
+
+#endif // THREADPOOL_HPP
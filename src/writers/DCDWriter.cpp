@@ -0,0 +1,134 @@
+#include "DCDWriter.hpp"
+#include <molpp/AtomSel.hpp>
+#include <cstring>
+#include <cstdint>
+
+using namespace mol::internal;
+
+namespace {
+
+size_t const HEADER_SIZE = 84;
+// Offset of the frame count in the file
+size_t const NSET_OFFSET = 8;
+int32_t const CHARMM_VERSION = 24;
+
+} // namespace
+
+DCDWriter::DCDWriter()
+: m_num_atoms { 0 },
+  m_num_frames { 0 }
+{}
+
+DCDWriter::~DCDWriter()
+{
+    close();
+}
+
+bool DCDWriter::can_write(std::string const &file_ext)
+{
+    return file_ext == ".dcd";
+}
+
+MolWriter::Status DCDWriter::open(std::string const &file_name, AtomSel &atoms)
+{
+    if (m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    m_stream.open(file_name, std::ios::binary | std::ios::trunc);
+    if (!m_stream.good())
+    {
+        m_stream.close();
+        return FAILED;
+    }
+    m_num_atoms = atoms.size();
+    m_num_frames = 0;
+
+    // "CORD" followed by 20 integers. Only CHARMM's version, unit
+    // cell flag and time step are set here.
+    int32_t fields[20] = {};
+    fields[2] = 1;
+    float const delta = 1;
+    std::memcpy(&fields[9], &delta, sizeof(delta));
+    fields[10] = 1;
+    fields[19] = CHARMM_VERSION;
+    char header[HEADER_SIZE];
+    std::memcpy(header, "CORD", 4);
+    std::memcpy(header + 4, fields, sizeof(fields));
+    write_record(header, HEADER_SIZE);
+
+    char title[84] = {};
+    int32_t const num_titles = 1;
+    std::memcpy(title, &num_titles, sizeof(num_titles));
+    std::memset(title + 4, ' ', 80);
+    std::memcpy(title + 4, "REMARKS Written by molpp", 24);
+    write_record(title, sizeof(title));
+
+    int32_t const num_atoms = m_num_atoms;
+    write_record(&num_atoms, sizeof(num_atoms));
+
+    return m_stream.good() ? SUCCESS : FAILED;
+}
+
+MolWriter::Status DCDWriter::close()
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    // Frame count and last step
+    int32_t const num_frames = m_num_frames;
+    m_stream.seekp(NSET_OFFSET);
+    m_stream.write(reinterpret_cast<char const *>(&num_frames), sizeof(num_frames));
+    m_stream.seekp(NSET_OFFSET + 12);
+    m_stream.write(reinterpret_cast<char const *>(&num_frames), sizeof(num_frames));
+    bool const failed = m_stream.fail();
+    m_stream.close();
+    return (failed || m_stream.fail()) ? FAILED : SUCCESS;
+}
+
+MolWriter::Status DCDWriter::write_timestep(Timestep const &timestep)
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    ConstCoord3Map const coords = timestep.coords();
+    if ((size_t)coords.cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    // Stored as A, gamma, B, beta, alpha and C, with angles in degrees
+    Point3 const& lengths = timestep.cell().lengths();
+    Point3 const& angles = timestep.cell().angles();
+    double const cell[6] = {lengths(0), angles(2), lengths(1), angles(1), angles(0), lengths(2)};
+    write_record(cell, sizeof(cell));
+
+    // X, Y and Z are separate blocks
+    m_block.resize(m_num_atoms);
+    for (size_t dim = 0; dim < 3; ++dim)
+    {
+        Eigen::Map<Eigen::RowVectorXf>(m_block.data(), m_num_atoms) = coords.row(dim);
+        write_record(m_block.data(), sizeof(float) * m_num_atoms);
+    }
+
+    if (!m_stream.good())
+    {
+        return FAILED;
+    }
+
+    ++m_num_frames;
+    return SUCCESS;
+}
+
+void DCDWriter::write_record(void const *data, size_t const size)
+{
+    int32_t const length = size;
+    m_stream.write(reinterpret_cast<char const *>(&length), sizeof(length));
+    m_stream.write(reinterpret_cast<char const *>(data), size);
+    m_stream.write(reinterpret_cast<char const *>(&length), sizeof(length));
+}
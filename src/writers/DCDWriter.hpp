@@ -0,0 +1,35 @@
+#ifndef DCDWRITER_HPP
+#define DCDWRITER_HPP
+
+#include "MolWriter.hpp"
+#include <fstream>
+#include <vector>
+
+namespace mol::internal {
+
+// Native writer for CHARMM DCD trajectories, in native byte order and
+// with a unit cell record in every frame. The frame count in the
+// header is updated when the file is closed.
+class DCDWriter : public MolWriter
+{
+public:
+    DCDWriter();
+    ~DCDWriter();
+    static bool can_write(std::string const &file_ext);
+    Status open(std::string const &file_name, AtomSel &atoms) override;
+    Status close() override;
+    Status write_timestep(Timestep const &timestep) override;
+
+private:
+    void write_record(void const *data, size_t const size);
+
+    std::ofstream m_stream;
+    size_t m_num_atoms;
+    size_t m_num_frames;
+    // Reused between frames
+    std::vector<float> m_block;
+};
+
+} // namespace mol::internal
+
+#endif // DCDWRITER_HPP
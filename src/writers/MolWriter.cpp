@@ -0,0 +1,32 @@
+#include "MolWriter.hpp"
+#include "XTCWriter.hpp"
+#include "TRRWriter.hpp"
+#include "DCDWriter.hpp"
+#include "PDBWriter.hpp"
+
+using namespace mol::internal;
+
+std::shared_ptr<MolWriter> MolWriter::from_file_ext(const std::string &file_ext)
+{
+    if (XTCWriter::can_write(file_ext))
+    {
+        return std::make_shared<XTCWriter>();
+    }
+
+    if (TRRWriter::can_write(file_ext))
+    {
+        return std::make_shared<TRRWriter>();
+    }
+
+    if (DCDWriter::can_write(file_ext))
+    {
+        return std::make_shared<DCDWriter>();
+    }
+
+    if (PDBWriter::can_write(file_ext))
+    {
+        return std::make_shared<PDBWriter>();
+    }
+
+    return nullptr;
+}
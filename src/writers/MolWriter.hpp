@@ -0,0 +1,39 @@
+#ifndef MOLWRITER_HPP
+#define MOLWRITER_HPP
+
+#include <molpp/Timestep.hpp>
+#include <string>
+#include <memory>
+
+namespace mol {
+class AtomSel;
+}
+
+namespace mol::internal
+{
+
+class MolWriter
+{
+public:
+    enum Status
+    {
+        SUCCESS,
+        INVALID,
+        WRONG_ATOMS,
+        FAILED,
+    };
+
+    static std::shared_ptr<MolWriter> from_file_ext(std::string const &file_ext);
+    virtual ~MolWriter() {};
+    // Files hold the given atoms, in their order. Formats with a
+    // topology take it from them.
+    virtual Status open(std::string const &file_name, AtomSel &atoms) = 0;
+    // Flushes pending data. Returns FAILED on I/O errors.
+    virtual Status close() = 0;
+    // Timesteps hold only the atoms written
+    virtual Status write_timestep(Timestep const &timestep) = 0;
+};
+
+} // namespace mol::internal
+
+#endif // MOLWRITER_HPP
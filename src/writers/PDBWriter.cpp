@@ -0,0 +1,130 @@
+#include "PDBWriter.hpp"
+#include <molpp/AtomSel.hpp>
+#include <molpp/ElementsTable.hpp>
+#include <cstdio>
+
+using namespace mol::internal;
+
+namespace {
+
+// Serials and residue ids wrap around instead of breaking the columns
+int const MAX_SERIAL = 100000;
+int const MAX_RESID = 10000;
+
+} // namespace
+
+PDBWriter::PDBWriter()
+: m_current { 0 }
+{}
+
+PDBWriter::~PDBWriter()
+{
+    close();
+}
+
+bool PDBWriter::can_write(std::string const &file_ext)
+{
+    return file_ext == ".pdb";
+}
+
+MolWriter::Status PDBWriter::open(std::string const &file_name, AtomSel &atoms)
+{
+    if (m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    m_stream.open(file_name, std::ios::trunc);
+    if (!m_stream.good())
+    {
+        m_stream.close();
+        return FAILED;
+    }
+
+    ElementsTable const& elements_table = ELEMENTS_TABLE();
+    m_prefixes.clear();
+    m_suffixes.clear();
+    int serial = 1;
+    for (Atom const atom : atoms)
+    {
+        // Names shorter than 4 characters start at the 14th column
+        std::string name = atom.name().substr(0, 4);
+        if (name.size() < 4)
+        {
+            name = " " + name;
+        }
+        std::string const altloc = atom.altloc();
+        std::string const chain = atom.chain();
+        char buffer[81];
+        std::snprintf(buffer, sizeof(buffer), "ATOM  %5d %-4s%c%-4s%c%4d    ",
+                      serial % MAX_SERIAL, name.c_str(), altloc.empty() ? ' ' : altloc[0],
+                      atom.resname().substr(0, 4).c_str(), chain.empty() ? ' ' : chain[0],
+                      atom.resid() % MAX_RESID);
+        m_prefixes.push_back(buffer);
+
+        int const atomic = atom.atomic();
+        std::string const element = (atomic > 0) ? elements_table.symbol(atomic) : "";
+        std::snprintf(buffer, sizeof(buffer), "%6.2f%6.2f      %-4s%2s\n",
+                      atom.occupancy(), atom.tempfactor(), atom.segid().substr(0, 4).c_str(), element.substr(0, 2).c_str());
+        m_suffixes.push_back(buffer);
+        ++serial;
+    }
+
+    m_current = 0;
+    return SUCCESS;
+}
+
+MolWriter::Status PDBWriter::close()
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    m_stream << "END\n";
+    bool const failed = m_stream.fail();
+    m_stream.close();
+    return (failed || m_stream.fail()) ? FAILED : SUCCESS;
+}
+
+MolWriter::Status PDBWriter::write_timestep(Timestep const &timestep)
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    ConstCoord3Map const coords = timestep.coords();
+    if ((size_t)coords.cols() != m_prefixes.size())
+    {
+        return WRONG_ATOMS;
+    }
+
+    char buffer[81];
+    std::snprintf(buffer, sizeof(buffer), "MODEL     %4zu\n", (m_current + 1) % MAX_RESID);
+    m_stream << buffer;
+
+    UnitCell const& cell = timestep.cell();
+    if (cell.is_periodic())
+    {
+        std::snprintf(buffer, sizeof(buffer), "CRYST1%9.3f%9.3f%9.3f%7.2f%7.2f%7.2f P 1           1\n",
+                      cell.lengths()(0), cell.lengths()(1), cell.lengths()(2),
+                      cell.angles()(0), cell.angles()(1), cell.angles()(2));
+        m_stream << buffer;
+    }
+
+    for (size_t i = 0; i < m_prefixes.size(); ++i)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%8.3f%8.3f%8.3f", coords(0, i), coords(1, i), coords(2, i));
+        m_stream << m_prefixes[i] << buffer << m_suffixes[i];
+    }
+    m_stream << "ENDMDL\n";
+
+    if (!m_stream.good())
+    {
+        return FAILED;
+    }
+
+    ++m_current;
+    return SUCCESS;
+}
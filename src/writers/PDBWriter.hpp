@@ -0,0 +1,32 @@
+#ifndef PDBWRITER_HPP
+#define PDBWRITER_HPP
+
+#include "MolWriter.hpp"
+#include <fstream>
+#include <vector>
+
+namespace mol::internal {
+
+// Native writer for multi-model PDB files. Atom records are formatted
+// once when the file is opened, so that frames only format coordinates.
+class PDBWriter : public MolWriter
+{
+public:
+    PDBWriter();
+    ~PDBWriter();
+    static bool can_write(std::string const &file_ext);
+    Status open(std::string const &file_name, AtomSel &atoms) override;
+    Status close() override;
+    Status write_timestep(Timestep const &timestep) override;
+
+private:
+    std::ofstream m_stream;
+    // Columns before and after the coordinates
+    std::vector<std::string> m_prefixes;
+    std::vector<std::string> m_suffixes;
+    size_t m_current;
+};
+
+} // namespace mol::internal
+
+#endif // PDBWRITER_HPP
@@ -0,0 +1,82 @@
+#include "TRRWriter.hpp"
+#include "readers/trr.hpp"
+#include <molpp/AtomSel.hpp>
+
+using namespace mol::internal;
+
+TRRWriter::TRRWriter()
+: m_num_atoms { 0 },
+  m_current { 0 }
+{}
+
+TRRWriter::~TRRWriter()
+{
+    close();
+}
+
+bool TRRWriter::can_write(std::string const &file_ext)
+{
+    return file_ext == ".trr";
+}
+
+MolWriter::Status TRRWriter::open(std::string const &file_name, AtomSel &atoms)
+{
+    if (m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    m_stream.open(file_name, std::ios::binary | std::ios::trunc);
+    if (!m_stream.good())
+    {
+        m_stream.close();
+        return FAILED;
+    }
+
+    m_num_atoms = atoms.size();
+    m_current = 0;
+    return SUCCESS;
+}
+
+MolWriter::Status TRRWriter::close()
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    m_stream.close();
+    return m_stream.fail() ? FAILED : SUCCESS;
+}
+
+MolWriter::Status TRRWriter::write_timestep(Timestep const &timestep)
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    ConstCoord3Map const coords = timestep.coords();
+    if ((size_t)coords.cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    trr::Header header {};
+    header.num_atoms = m_num_atoms;
+    header.step = m_current;
+    header.time = timestep.time();
+    Box3 const box = timestep.cell().is_periodic() ? timestep.cell().vectors() : Box3(Box3::Zero());
+
+    m_buffer.clear();
+    trr::write_frame(header, box.data(), coords.data(), m_buffer);
+
+    m_stream.write(reinterpret_cast<char const *>(m_buffer.data()), m_buffer.size());
+    if (!m_stream.good())
+    {
+        return FAILED;
+    }
+
+    ++m_current;
+    return SUCCESS;
+}
@@ -0,0 +1,32 @@
+#ifndef TRRWRITER_HPP
+#define TRRWRITER_HPP
+
+#include "MolWriter.hpp"
+#include <fstream>
+#include <vector>
+
+namespace mol::internal {
+
+// Native writer for Gromacs' TRR trajectories, in single precision
+// and with coordinates only. Frames are numbered from zero.
+class TRRWriter : public MolWriter
+{
+public:
+    TRRWriter();
+    ~TRRWriter();
+    static bool can_write(std::string const &file_ext);
+    Status open(std::string const &file_name, AtomSel &atoms) override;
+    Status close() override;
+    Status write_timestep(Timestep const &timestep) override;
+
+private:
+    std::ofstream m_stream;
+    size_t m_num_atoms;
+    size_t m_current;
+    // Reused between frames
+    std::vector<unsigned char> m_buffer;
+};
+
+} // namespace mol::internal
+
+#endif // TRRWRITER_HPP
@@ -0,0 +1,88 @@
+#include "XTCWriter.hpp"
+#include "readers/xtc.hpp"
+#include <molpp/AtomSel.hpp>
+#include <algorithm>
+
+using namespace mol::internal;
+
+XTCWriter::XTCWriter()
+: m_num_atoms { 0 },
+  m_current { 0 }
+{}
+
+XTCWriter::~XTCWriter()
+{
+    close();
+}
+
+bool XTCWriter::can_write(std::string const &file_ext)
+{
+    return file_ext == ".xtc";
+}
+
+MolWriter::Status XTCWriter::open(std::string const &file_name, AtomSel &atoms)
+{
+    if (m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    m_stream.open(file_name, std::ios::binary | std::ios::trunc);
+    if (!m_stream.good())
+    {
+        m_stream.close();
+        return FAILED;
+    }
+
+    m_num_atoms = atoms.size();
+    m_current = 0;
+    return SUCCESS;
+}
+
+MolWriter::Status XTCWriter::close()
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    m_stream.close();
+    return m_stream.fail() ? FAILED : SUCCESS;
+}
+
+MolWriter::Status XTCWriter::write_timestep(Timestep const &timestep)
+{
+    if (!m_stream.is_open())
+    {
+        return INVALID;
+    }
+
+    ConstCoord3Map const coords = timestep.coords();
+    if ((size_t)coords.cols() != m_num_atoms)
+    {
+        return WRONG_ATOMS;
+    }
+
+    // Box vectors are in nanometers
+    xtc::Header header;
+    header.num_atoms = m_num_atoms;
+    header.step = m_current;
+    header.time = timestep.time();
+    Box3 const box = timestep.cell().is_periodic() ? Box3(timestep.cell().vectors() / 10) : Box3(Box3::Zero());
+    std::copy(box.data(), box.data() + 9, header.box);
+
+    m_buffer.clear();
+    if (!xtc::write_frame(header, coords.data(), xtc::DEFAULT_PRECISION, m_buffer))
+    {
+        return FAILED;
+    }
+
+    m_stream.write(reinterpret_cast<char const *>(m_buffer.data()), m_buffer.size());
+    if (!m_stream.good())
+    {
+        return FAILED;
+    }
+
+    ++m_current;
+    return SUCCESS;
+}
@@ -0,0 +1,32 @@
+#ifndef XTCWRITER_HPP
+#define XTCWRITER_HPP
+
+#include "MolWriter.hpp"
+#include <fstream>
+#include <vector>
+
+namespace mol::internal {
+
+// Native writer for Gromacs' XTC trajectories, at the default
+// precision of 0.001 nm. Frames are numbered from zero.
+class XTCWriter : public MolWriter
+{
+public:
+    XTCWriter();
+    ~XTCWriter();
+    static bool can_write(std::string const &file_ext);
+    Status open(std::string const &file_name, AtomSel &atoms) override;
+    Status close() override;
+    Status write_timestep(Timestep const &timestep) override;
+
+private:
+    std::ofstream m_stream;
+    size_t m_num_atoms;
+    size_t m_current;
+    // Reused between frames
+    std::vector<unsigned char> m_buffer;
+};
+
+} // namespace mol::internal
+
+#endif // XTCWRITER_HPP
@@ -3,12 +3,19 @@
 #include "auxiliary.hpp"
 #include "core/MolData.hpp"
 #include "core/AtomData.hpp"
+#include "core/TimestepPool.hpp"
+#include "core/CompressedFrames.hpp"
+#include "core/ConcatenatedFrames.hpp"
 #include <molpp/Atom.hpp>
 #include <molpp/Residue.hpp>
 #include <molpp/AtomSel.hpp>
 #include <molpp/MolError.hpp>
+#include <molpp/QuantizedTimestep.hpp>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <random>
+#include <thread>
+#include <atomic>
 
 using namespace mol;
 using namespace mol::internal;
@@ -20,6 +27,12 @@ TEST(Atoms, Timestep) {
     ts.coords() << 1, 2, 3, 4, 5, 6;
     EXPECT_THAT(ts.coords().reshaped(), ElementsAre(1, 3, 5, 2, 4, 6));
 
+    // Coordinates can be kept by reference
+    auto& coords = ts.coords();
+    coords(0, 1) = 20;
+    EXPECT_EQ(ts.coords()(0, 1), 20);
+    coords(0, 1) = 2;
+
     // Note: ts is invalid from this on
     float *data = ts.coords().data();
     Timestep moved(std::move(ts));
@@ -33,6 +46,84 @@ TEST(Atoms, Timestep) {
     EXPECT_THAT(moved_again.coords().reshaped(), ElementsAre(1, 3, 5, 2, 4, 6));
 }
 
+TEST(Atoms, QuantizedTimestep) {
+    QuantizedTimestep empty;
+    EXPECT_EQ(empty.size(), 0);
+    EXPECT_EQ(QuantizedTimestep(Timestep(0)).size(), 0);
+
+    Timestep ts(4);
+    ts.coords() << -10, 0, 5, 30,
+                   1, 1, 1, 1,
+                   -2, 2, 0.5, 0.25;
+    ts.cell() = UnitCell({40, 40, 40});
+    QuantizedTimestep quantized(ts);
+    EXPECT_EQ(quantized.size(), 4);
+    EXPECT_EQ(quantized.origin(), Point3(10, 1, 0));
+    EXPECT_FLOAT_EQ(quantized.scale(), 20.0 / 32767);
+    EXPECT_EQ(quantized.data().cwiseAbs().maxCoeff(), 32767);
+    EXPECT_EQ(quantized.cell().lengths(), Point3(40, 40, 40));
+    EXPECT_LE((quantized.coords() - ts.coords()).cwiseAbs().maxCoeff(), quantized.precision());
+    EXPECT_LE((Point3(quantized.coords().col(3)) - Point3(30, 1, 0.25)).cwiseAbs().maxCoeff(), quantized.precision());
+
+    Timestep decoded = quantized.decode();
+    EXPECT_LE((decoded.coords() - ts.coords()).cwiseAbs().maxCoeff(), quantized.precision());
+    EXPECT_EQ(decoded.cell().lengths(), Point3(40, 40, 40));
+    EXPECT_TRUE(quantized.within_tolerance());
+
+    // About 1310 angstroms wide at most
+    Timestep wide(2);
+    wide.coords() << 0, 1400, 0, 0, 0, 0;
+    EXPECT_GT(QuantizedTimestep(wide).precision(), QuantizedTimestep::TOLERANCE);
+    EXPECT_FALSE(QuantizedTimestep(wide).within_tolerance());
+
+    // Quantized trajectories keep a single frame widened
+    Trajectory traj;
+    traj.set_quantization(true);
+    EXPECT_TRUE(traj.quantization());
+    Timestep copy(4);
+    copy.coords() = ts.coords();
+    copy.time() = 2;
+    traj.add_timestep(std::move(copy));
+    EXPECT_THROW(traj.add_timestep(std::move(wide)), MolError);
+    ASSERT_EQ(traj.num_frames(), 1);
+    EXPECT_EQ(traj.time(0), 2);
+    EXPECT_LE((traj.timestep(0).coords() - ts.coords()).cwiseAbs().maxCoeff(), quantized.precision());
+
+    // Compression prevails
+    traj.set_compression(0.001);
+    Timestep zeros(4);
+    zeros.coords().setZero();
+    traj.add_timestep(std::move(zeros));
+    EXPECT_EQ(traj.timestep(1).coords().cwiseAbs().maxCoeff(), 0);
+}
+
+TEST(Atoms, UnitCell) {
+    UnitCell empty;
+    EXPECT_FALSE(empty.is_periodic());
+    EXPECT_TRUE(empty.is_orthorhombic());
+    EXPECT_EQ(Timestep(2).cell().lengths(), Point3::Zero());
+
+    UnitCell box({10, 20, 30});
+    EXPECT_TRUE(box.is_periodic());
+    EXPECT_TRUE(box.is_orthorhombic());
+    EXPECT_EQ(box.vectors(), Box3(Point3(10, 20, 30).asDiagonal()));
+    UnitCell const from_box = UnitCell::from_vectors(box.vectors());
+    EXPECT_TRUE(from_box.lengths().isApprox(Point3(10, 20, 30)));
+    EXPECT_TRUE(from_box.angles().isApprox(Point3(90, 90, 90)));
+
+    // Truncated octahedron
+    UnitCell skewed({10, 10, 10}, {70.5288, 109.4712, 70.5288});
+    EXPECT_TRUE(skewed.is_periodic());
+    EXPECT_FALSE(skewed.is_orthorhombic());
+    Box3 const vectors = skewed.vectors();
+    EXPECT_FLOAT_EQ(vectors(1, 0), 0);
+    EXPECT_FLOAT_EQ(vectors(2, 0), 0);
+    EXPECT_FLOAT_EQ(vectors(2, 1), 0);
+    UnitCell const from_skewed = UnitCell::from_vectors(vectors);
+    EXPECT_TRUE(from_skewed.lengths().isApprox(skewed.lengths(), 1e-5));
+    EXPECT_TRUE(from_skewed.angles().isApprox(skewed.angles(), 1e-5));
+}
+
 TEST(Atoms, MolData) {
     size_t const num_atoms { 3 };
     MolData data(num_atoms);
@@ -55,6 +146,392 @@ TEST(Atoms, Trajectory) {
     EXPECT_EQ(traj_data.timestep(0).coords().cols(), num_atoms);
 }
 
+TEST(Atoms, ConcurrentTrajectory) {
+    // Frames filled with their index
+    class IndexFrames : public FrameSource
+    {
+    public:
+        size_t num_atoms() const override { return 10; }
+        size_t num_frames() const override { return 200; }
+        void read(size_t const index, Timestep &timestep) override
+        {
+            if (timestep.coords().cols() == 0)
+            {
+                timestep = Timestep(num_atoms());
+            }
+            timestep.coords().setConstant(index);
+        }
+    };
+
+    Trajectory traj;
+    traj.add_frames(std::make_shared<IndexFrames>());
+    Trajectory const& const_traj = traj;
+
+    // Threads decoding the same lazy frames
+    std::vector<std::thread> threads;
+    std::atomic<size_t> errors { 0 };
+    for (size_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&const_traj, &errors, t]()
+        {
+            for (size_t i = 0; i < const_traj.num_frames(); ++i)
+            {
+                size_t const frame = (i * (t + 1)) % const_traj.num_frames();
+                ConstCoord3Map const coords = const_traj.timestep(frame).coords();
+                if (coords.cols() != 10 || coords.minCoeff() != frame || coords.maxCoeff() != frame)
+                {
+                    ++errors;
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(traj.cache_stats().misses, traj.num_frames());
+}
+
+TEST(Atoms, TransientFrameWrites) {
+    // Frames that keep the first coordinate written to them
+    class WritableFrames : public FrameSource
+    {
+    public:
+        size_t num_atoms() const override { return 2; }
+        size_t num_frames() const override { return values.size(); }
+        void read(size_t const index, Timestep &timestep) override
+        {
+            if (timestep.coords().cols() == 0)
+            {
+                timestep = Timestep(num_atoms());
+            }
+            timestep.coords().setConstant(values[index]);
+        }
+        bool write(size_t const index, Timestep const& timestep) override
+        {
+            ++writes;
+            if (writable)
+            {
+                values[index] = timestep.coords()(0, 0);
+            }
+            return writable;
+        }
+        bool persistent() const override { return cached; }
+
+        std::vector<float> values = {0, 1, 2, 3};
+        size_t writes = 0;
+        bool cached = false;
+        bool writable = true;
+    };
+
+    auto source = std::make_shared<WritableFrames>();
+    Trajectory traj;
+    traj.add_frames(source);
+    Trajectory const& const_traj = traj;
+
+    // Read only accesses are not stored back
+    for (size_t frame : {0, 1, 2, 3, 0})
+    {
+        EXPECT_EQ(const_traj.timestep(frame).coords()(0, 0), frame);
+    }
+    EXPECT_EQ(source->writes, 0);
+
+    traj.timestep(1).coords()(0, 0) = 10;
+    EXPECT_EQ(const_traj.timestep(2).coords()(0, 0), 2);
+    EXPECT_EQ(source->writes, 1);
+    EXPECT_EQ(const_traj.timestep(1).coords()(0, 0), 10);
+    EXPECT_EQ(const_traj.timestep(3).coords()(0, 0), 3);
+    EXPECT_EQ(source->writes, 1);
+
+    // Same for the frames evicted from the cache
+    size_t const frame_bytes = 2 * 3 * sizeof(position_t);
+    for (bool const writable : {true, false})
+    {
+        auto cached = std::make_shared<WritableFrames>();
+        cached->cached = true;
+        cached->writable = writable;
+        Trajectory cached_traj;
+        cached_traj.set_cache_size(2 * frame_bytes);
+        cached_traj.add_frames(cached);
+        Trajectory const& const_cached = cached_traj;
+
+        cached_traj.timestep(0).coords()(0, 0) = 42;
+        for (size_t frame : {1, 2, 3})
+        {
+            EXPECT_EQ(const_cached.timestep(frame).coords()(0, 0), frame);
+        }
+        EXPECT_EQ(cached->writes, 1);
+        EXPECT_EQ(cached->values[0], writable ? 42 : 0);
+        EXPECT_EQ(const_cached.timestep(0).coords()(0, 0), 42);
+        EXPECT_EQ(const_cached.timestep(1).coords()(0, 0), 1);
+        EXPECT_EQ(cached->writes, 1);
+    }
+}
+
+TEST(Atoms, TimestepPool) {
+    TimestepPool pool;
+    EXPECT_EQ(pool.acquire(2).coords().cols(), 0);
+
+    Timestep ts(2);
+    float *data = ts.coords().data();
+    pool.release(std::move(ts));
+    pool.release(Timestep());
+    float view_data[3] = {};
+    pool.release(Timestep(view_data, 1, std::make_shared<int>()));
+    EXPECT_EQ(pool.size(), 1);
+
+    // Only matching sizes are reused
+    EXPECT_EQ(pool.acquire(3).coords().cols(), 0);
+    Timestep reused = pool.acquire(2);
+    EXPECT_EQ(reused.coords().data(), data);
+    EXPECT_EQ(pool.size(), 0);
+
+    pool.release(std::move(reused));
+    pool.clear();
+    EXPECT_EQ(pool.size(), 0);
+
+    // Buffers beyond the capacity are freed
+    TimestepPool small(2);
+    EXPECT_EQ(small.capacity(), 2);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        small.release(Timestep(2));
+    }
+    EXPECT_EQ(small.size(), 2);
+
+    // Cleared trajectories feed their pools
+    Trajectory traj;
+    traj.add_timestep(Timestep(2));
+    traj.add_timestep(Timestep(2));
+    traj.clear();
+    EXPECT_EQ(traj.num_frames(), 0);
+    EXPECT_EQ(traj.pool().size(), 2);
+    traj.add_timestep(Timestep(2));
+    traj.clear(false);
+    EXPECT_EQ(traj.pool().size(), 0);
+    for (size_t i = 0; i < 2 * TimestepPool::DEFAULT_CAPACITY; ++i)
+    {
+        traj.add_timestep(Timestep(2));
+    }
+    traj.clear();
+    EXPECT_EQ(traj.pool().size(), TimestepPool::DEFAULT_CAPACITY);
+}
+
+TEST(Atoms, FrameChunks) {
+    size_t const num_atoms { 2 };
+    Trajectory traj;
+    traj.set_chunk_frames(3);
+    EXPECT_EQ(traj.chunk_frames(), 3);
+    for (size_t i = 0; i < 5; ++i)
+    {
+        Timestep ts(num_atoms);
+        ts.coords().setConstant(i);
+        traj.add_timestep(std::move(ts));
+    }
+    // Buffers read go back to the pool
+    EXPECT_EQ(traj.pool().size(), 5);
+
+    // Frames of a chunk are back to back
+    for (size_t i = 0; i < 5; ++i)
+    {
+        Timestep const& ts = traj.timestep(i);
+        EXPECT_TRUE(ts.is_view());
+        EXPECT_THAT(ts.coords().reshaped(), Each(FloatEq(i)));
+    }
+    position_t const *first = traj.timestep(0).coords().data();
+    EXPECT_EQ(traj.timestep(2).coords().data(), first + 2 * 3 * num_atoms);
+    EXPECT_EQ(traj.timestep(4).coords().data(), traj.timestep(3).coords().data() + 3 * num_atoms);
+
+    // Frames of other sizes start new chunks
+    traj.add_timestep(Timestep(1));
+    EXPECT_EQ(traj.timestep(5).coords().cols(), 1);
+
+    traj.set_chunk_frames(0);
+    traj.add_timestep(Timestep(num_atoms));
+    EXPECT_FALSE(traj.timestep(6).is_view());
+}
+
+TEST(Atoms, TimeSeries) {
+    size_t const num_atoms { 70 };
+    size_t const num_frames { 150 };
+    Trajectory traj;
+    EXPECT_EQ(traj.time_series().size(), 0);
+
+    // Compressed frames are only decoded one at a time
+    std::vector<Coord3> coords;
+    for (size_t i = 0; i < num_frames; ++i)
+    {
+        if (i == num_frames / 2)
+        {
+            traj.set_compression(0.001);
+        }
+        Timestep ts(num_atoms);
+        ts.coords().setRandom();
+        coords.push_back(ts.coords());
+        traj.add_timestep(std::move(ts));
+    }
+
+    ConstTimeSeriesMap series = traj.time_series(3);
+    ASSERT_EQ(series.rows(), 3 * num_frames);
+    ASSERT_EQ(series.cols(), num_atoms);
+    for (size_t i = 0; i < num_frames; ++i)
+    {
+        Coord3 const expected = coords[i];
+        Coord3 const actual = series.middleRows(3 * i, 3);
+        EXPECT_LE((actual - expected).cwiseAbs().maxCoeff(), 0.001);
+    }
+
+    // Cached until frames change
+    EXPECT_EQ(traj.time_series().data(), series.data());
+    traj.add_timestep(Timestep(num_atoms));
+    EXPECT_EQ(traj.time_series().rows(), 3 * (num_frames + 1));
+    traj.add_timestep(Timestep(1));
+    EXPECT_THROW(traj.time_series(), MolError);
+}
+
+TEST(Atoms, CompressedFrames) {
+    size_t const num_atoms = 50;
+    size_t const num_frames = 20;
+    float const precision = 0.001;
+    EXPECT_THROW(CompressedFrames(num_atoms, 0), MolError);
+
+    // Random walk
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> start(-50, 50);
+    std::normal_distribution<float> step(0, 0.2);
+    std::vector<Coord3> frames;
+    frames.push_back(Coord3(3, num_atoms));
+    frames[0] = frames[0].unaryExpr([&](float) { return start(generator); });
+    for (size_t i = 1; i < num_frames; ++i)
+    {
+        frames.push_back(frames[i - 1].unaryExpr([&](float value) { return value + step(generator); }));
+    }
+
+    CompressedFrames compressed(num_atoms, precision, 8);
+    EXPECT_EQ(compressed.num_atoms(), num_atoms);
+    EXPECT_FALSE(compressed.persistent());
+    for (size_t i = 0; i < num_frames; ++i)
+    {
+        Timestep ts(num_atoms);
+        ts.coords() = frames[i];
+        ts.cell() = UnitCell({10, 20, float(i)});
+        EXPECT_EQ(compressed.add(ts), i);
+    }
+    EXPECT_EQ(compressed.num_frames(), num_frames);
+    EXPECT_THROW(compressed.add(Timestep(1)), MolError);
+    EXPECT_LT(compressed.compressed_size(), num_frames * num_atoms * 3 * sizeof(float) / 2);
+
+    // Frames are decoded in any order
+    for (size_t i : {19, 0, 7, 8, 13})
+    {
+        Timestep ts;
+        compressed.read(i, ts);
+        EXPECT_LE((ts.coords() - frames[i]).cwiseAbs().maxCoeff(), precision);
+        EXPECT_EQ(ts.cell().lengths(), Point3(10, 20, i));
+    }
+    Timestep wrong(1);
+    EXPECT_THROW(compressed.read(0, wrong), MolError);
+    Timestep ts;
+    EXPECT_THROW(compressed.read(num_frames, ts), MolError);
+    for (size_t i = 0; i < num_frames; ++i)
+    {
+        compressed.read(i, ts);
+        EXPECT_LE((ts.coords() - frames[i]).cwiseAbs().maxCoeff(), precision);
+    }
+
+    // Changed frames are encoded again with the rest of their block
+    compressed.read(10, ts);
+    ts.coords()(1, 2) = frames[10](1, 2) = 1234;
+    EXPECT_TRUE(compressed.write(10, ts));
+    EXPECT_FALSE(compressed.write(10, wrong));
+    for (size_t i : {11, 9, 10, 8, 15})
+    {
+        compressed.read(i, ts);
+        EXPECT_LE((ts.coords() - frames[i]).cwiseAbs().maxCoeff(), precision);
+    }
+
+    // Compressed trajectories keep a single frame decoded
+    Trajectory traj;
+    EXPECT_THROW(traj.set_compression(-1), MolError);
+    traj.set_compression(precision);
+    EXPECT_EQ(traj.compression(), precision);
+    for (size_t i = 0; i < num_frames; ++i)
+    {
+        Timestep ts(num_atoms);
+        ts.coords() = frames[i];
+        traj.add_timestep(std::move(ts));
+    }
+    EXPECT_EQ(traj.num_frames(), num_frames);
+    EXPECT_LE((traj.timestep(3).coords() - frames[3]).cwiseAbs().maxCoeff(), precision);
+    EXPECT_LE((traj.timestep(11).coords() - frames[11]).cwiseAbs().maxCoeff(), precision);
+    EXPECT_EQ(traj.timestep(3).coords().cols(), num_atoms);
+    EXPECT_LE((traj.timestep(3).coords() - frames[3]).cwiseAbs().maxCoeff(), precision);
+
+    // Changes survive decoding other frames, the last one included
+    traj.timestep(4).coords()(0, 0) = 999;
+    traj.timestep(19).coords()(0, 1) = -999;
+    Timestep next(num_atoms);
+    next.coords() = frames[19];
+    traj.add_timestep(std::move(next));
+    EXPECT_LE((traj.timestep(20).coords() - frames[19]).cwiseAbs().maxCoeff(), precision);
+    EXPECT_NEAR(traj.timestep(4).coords()(0, 0), 999, precision);
+    EXPECT_LE((traj.timestep(5).coords() - frames[5]).cwiseAbs().maxCoeff(), precision);
+    EXPECT_NEAR(traj.timestep(19).coords()(0, 1), -999, precision);
+    EXPECT_NEAR(traj.timestep(4).coords()(0, 0), 999, precision);
+    EXPECT_LE((traj.timestep(20).coords() - frames[19]).cwiseAbs().maxCoeff(), precision);
+
+    // Disabled compression only affects new frames
+    traj.set_compression(0);
+    traj.add_timestep(Timestep(num_atoms));
+    ASSERT_EQ(traj.num_frames(), num_frames + 2);
+    EXPECT_LE((traj.timestep(5).coords() - frames[5]).cwiseAbs().maxCoeff(), precision);
+    float const *data = traj.timestep(num_frames + 1).coords().data();
+    traj.timestep(0);
+    EXPECT_EQ(traj.timestep(num_frames + 1).coords().data(), data);
+}
+
+TEST(Atoms, ConcatenatedFrames) {
+    size_t const num_atoms { 2 };
+    auto make_segment = [num_atoms](size_t const num_frames, position_t const first)
+    {
+        auto segment = std::make_shared<CompressedFrames>(num_atoms, 0.01);
+        for (size_t i = 0; i < num_frames; ++i)
+        {
+            Timestep ts(num_atoms);
+            ts.coords().setConstant(first + i);
+            segment->add(ts);
+        }
+        return segment;
+    };
+
+    ConcatenatedFrames frames;
+    EXPECT_EQ(frames.num_frames(), 0);
+    EXPECT_THROW(frames.locate(0), MolError);
+    frames.add(make_segment(3, 0));
+    frames.add(make_segment(0, 0));
+    frames.add(make_segment(2, 3));
+    frames.add(make_segment(1, 5));
+    EXPECT_THROW(frames.add(std::make_shared<CompressedFrames>(num_atoms + 1, 0.01)), MolError);
+    EXPECT_EQ(frames.num_segments(), 4);
+    EXPECT_EQ(frames.num_atoms(), num_atoms);
+    EXPECT_EQ(frames.num_frames(), 6);
+    EXPECT_FALSE(frames.persistent());
+
+    EXPECT_EQ(frames.locate(2), std::make_pair(size_t(0), size_t(2)));
+    EXPECT_EQ(frames.locate(3), std::make_pair(size_t(2), size_t(0)));
+    EXPECT_EQ(frames.locate(5), std::make_pair(size_t(3), size_t(0)));
+    EXPECT_THROW(frames.locate(6), MolError);
+
+    // Random access across segments
+    Timestep ts;
+    for (size_t const frame : {4, 0, 5, 2, 3})
+    {
+        frames.read(frame, ts);
+        EXPECT_THAT(ts.coords().reshaped(), Each(FloatNear(frame, 0.01)));
+    }
+}
+
 TEST(Atoms, AtomData) {
     AtomData props(1);
     EXPECT_EQ(props.size(), 1);
@@ -69,3 +546,25 @@ TEST(Atoms, AtomData) {
     EXPECT_EQ(props.type(0), "");
     EXPECT_EQ(props.altloc(0), "");
 }
+
+TEST(Atoms, AtomDataFill) {
+    struct Record
+    {
+        char name[8];
+        float mass;
+        int resid;
+    };
+    std::vector<Record> const records {{"N", 14.007, 1}, {"CA", 12.011, 1}, {"C", 12.011, 2}};
+
+    AtomData props(3);
+    props.fill_names(records, &Record::name);
+    props.fill_masses(records, &Record::mass);
+    props.fill_residues(records, [](Record const& record) { return record.resid - 1; });
+    EXPECT_EQ(props.name(0), "N");
+    EXPECT_EQ(props.name(1), "CA");
+    EXPECT_FLOAT_EQ(props.mass(0), 14.007);
+    EXPECT_FLOAT_EQ(props.mass(2), 12.011);
+    EXPECT_EQ(props.residue(1), 0);
+    EXPECT_EQ(props.residue(2), 1);
+    EXPECT_EQ(props.charge(2), 0);
+}
@@ -1,6 +1,17 @@
 #include "matchers.hpp"
 #include "readers/MolReader.hpp"
 #include "readers/MolfileReader.hpp"
+#include "readers/XTCReader.hpp"
+#include "readers/FrameIndex.hpp"
+#include "readers/ReadAhead.hpp"
+#include "readers/DCDReader.hpp"
+#include "readers/BINPOSReader.hpp"
+#include "readers/TRRReader.hpp"
+#include "readers/PDBReader.hpp"
+#include "readers/GROReader.hpp"
+#include "readers/trr.hpp"
+#include "readers/Snapshot.hpp"
+#include "readers/SnapshotReader.hpp"
 #include "core/MolData.hpp"
 #include <molpp/MolError.hpp>
 #include <molpp/Atom.hpp>
@@ -8,6 +19,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <optional>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 using namespace testing;
 using namespace mol;
@@ -311,6 +325,556 @@ TEST(Readers, XTC) {
     EXPECT_THAT(data->trajectory().timestep(1).coords().reshaped(), Pointwise(FloatNear(1e-5), {488.76004, 782.39008, -1.81000, 487.96002, 781.47003, -1.06000, 488.48004, 780.12000, -1.26000, 488.72003, 779.78003, -2.39000, 488.78003, 779.27002, -0.28000, 488.90002, 779.65002, 1.13000, 489.07001, 777.84003, -0.42000, 489.22000, 777.34998, 0.98000, 489.68002, 778.56006, 1.77000, 488.13004, 776.95007, -1.27000, 486.92001, 776.92004, -1.05000, 437.76001, 830.54004, -4.03000, 438.49002, 831.81006, -3.87000, 439.61002, 832.06000, -4.89000, 439.85001, 831.20001, -5.72000, 440.36005, 833.23004, -4.93000, 439.95001, 834.44000, -4.13000, 441.73001, 833.40002, -5.36000, 442.09003, 834.89008, -5.01000, 440.76001, 835.60004, -4.67000, 442.71002, 832.34998, -4.79000, 442.83002, 832.17004, -3.55000}));
 }
 
+TEST(Readers, NativeXTC) {
+    ASSERT_TRUE(XTCReader::can_read(".xtc"));
+    EXPECT_FALSE(XTCReader::can_read(".trr"));
+    XTCReader xtc_reader;
+    EXPECT_FALSE(xtc_reader.has_topology());
+    EXPECT_TRUE(xtc_reader.has_trajectory());
+    EXPECT_FALSE(xtc_reader.has_bonds());
+    EXPECT_TRUE(xtc_reader.can_seek());
+    EXPECT_EQ(xtc_reader.open("dipeptide.psf"), MolReader::FAILED);
+
+    // Reference coordinates
+    MolfileReader psf_reader(".psf");
+    ASSERT_EQ(psf_reader.open("dipeptide.psf"), MolReader::SUCCESS);
+    auto data = psf_reader.read_atoms();
+    psf_reader.close();
+    ASSERT_THAT(data, NotNull());
+    EXPECT_EQ(MolfileReader(".xtc").read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 2);
+
+    // The index is built on the first open
+    std::string const index_file = FrameIndex::sidecar("dipeptide.xtc");
+    std::filesystem::remove(index_file);
+    ASSERT_EQ(xtc_reader.open("dipeptide.xtc"), MolReader::SUCCESS);
+    EXPECT_TRUE(std::filesystem::exists(index_file));
+    FrameIndex index;
+    ASSERT_TRUE(index.load("dipeptide.xtc"));
+    EXPECT_EQ(index.size(), 2);
+    EXPECT_EQ(index.offset(1), 180);
+    EXPECT_EQ(index.frame_size(1), 180);
+
+    // Random access
+    ASSERT_EQ(xtc_reader.check_timestep_read(*data), MolReader::SUCCESS);
+    Timestep ts(data->size());
+    ASSERT_EQ(xtc_reader.seek_timestep(1), MolReader::SUCCESS);
+    ASSERT_EQ(xtc_reader.read_timestep(ts), MolReader::SUCCESS);
+    EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+    EXPECT_EQ(xtc_reader.read_timestep(ts), MolReader::END);
+    ASSERT_EQ(xtc_reader.seek_timestep(0), MolReader::SUCCESS);
+    ASSERT_EQ(xtc_reader.read_timestep(ts), MolReader::SUCCESS);
+    EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+    EXPECT_TRUE(ts.cell().is_periodic());
+    EXPECT_TRUE(ts.cell().lengths().isApprox(data->trajectory().timestep(0).cell().lengths(), 1e-4));
+    EXPECT_TRUE(ts.cell().angles().isApprox(data->trajectory().timestep(0).cell().angles(), 1e-4));
+    EXPECT_EQ(xtc_reader.skip_timestep(), MolReader::SUCCESS);
+    EXPECT_EQ(xtc_reader.skip_timestep(), MolReader::END);
+    EXPECT_EQ(xtc_reader.seek_timestep(3), MolReader::END);
+    xtc_reader.close();
+
+    // Reopening reuses the index and strided reads seek
+    ASSERT_TRUE(MolReader::from_file_ext(".xtc"));
+    EXPECT_EQ(MolReader::from_file_ext(".xtc")->read_trajectory("dipeptide.xtc", *data, 1), MolReader::SUCCESS);
+    EXPECT_EQ(MolReader::from_file_ext(".xtc")->read_trajectory("dipeptide.xtc", *data, 0, -1, 2), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 4);
+    EXPECT_THAT(data->trajectory().timestep(2).coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+    EXPECT_THAT(data->trajectory().timestep(3).coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+
+    // Batches are decoded in parallel
+    std::vector<Timestep> timesteps(3);
+    size_t num_read = 0;
+    ASSERT_EQ(xtc_reader.open("dipeptide.xtc"), MolReader::SUCCESS);
+    EXPECT_EQ(xtc_reader.read_timesteps({0, 1}, timesteps, num_read), MolReader::SUCCESS);
+    EXPECT_EQ(num_read, 2);
+    EXPECT_THAT(timesteps[0].coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+    EXPECT_THAT(timesteps[1].coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+    EXPECT_EQ(xtc_reader.read_timestep(timesteps[2]), MolReader::END);
+    EXPECT_EQ(xtc_reader.read_timesteps({1, 2, 3}, timesteps, num_read), MolReader::SUCCESS);
+    EXPECT_EQ(num_read, 1);
+    EXPECT_THAT(timesteps[0].coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+    timesteps[0] = Timestep(1);
+    EXPECT_EQ(xtc_reader.read_timesteps({0}, timesteps, num_read), MolReader::WRONG_ATOMS);
+    xtc_reader.close();
+
+    // Frames before a corrupt one are still read
+    std::string const corrupt_file = "corrupt.xtc";
+    std::filesystem::copy_file("dipeptide.xtc", corrupt_file, std::filesystem::copy_options::overwrite_existing);
+    {
+        std::fstream file(corrupt_file, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(index.offset(1) + 84); // Invalid precision index
+        file.write("\xff\xff\xff\xff", 4);
+    }
+    ASSERT_EQ(xtc_reader.open(corrupt_file), MolReader::SUCCESS);
+    timesteps[0] = Timestep();
+    EXPECT_EQ(xtc_reader.read_timesteps({0, 1}, timesteps, num_read), MolReader::FAILED);
+    EXPECT_EQ(num_read, 1);
+    EXPECT_THAT(timesteps[0].coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+    xtc_reader.close();
+    std::filesystem::remove(FrameIndex::sidecar(corrupt_file));
+    std::filesystem::remove(corrupt_file);
+
+    MolData batched(data->size());
+    EXPECT_EQ(xtc_reader.read_trajectory("dipeptide.xtc", batched), MolReader::SUCCESS);
+    EXPECT_EQ(xtc_reader.read_trajectory("dipeptide.xtc", batched, 1), MolReader::SUCCESS);
+    ASSERT_EQ(batched.trajectory().num_frames(), 3);
+    for (size_t frame = 0; frame < 3; ++frame)
+    {
+        EXPECT_THAT(batched.trajectory().timestep(frame).coords().reshaped(), ElementsAreArray(data->trajectory().timestep(frame).coords().reshaped()));
+    }
+
+    std::filesystem::remove(index_file);
+}
+
+TEST(Readers, FrameIndexSave) {
+    std::string const index_file = FrameIndex::sidecar("dipeptide.xtc");
+    std::filesystem::remove(index_file);
+
+    // Concurrent saves each write their own temporary file, and
+    // one of them is published whole
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t]()
+        {
+            FrameIndex index;
+            for (size_t i = 0; i < 90 * (t + 1); ++i)
+            {
+                index.add_frame(i, 1);
+            }
+            index.save("dipeptide.xtc");
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    FrameIndex index;
+    ASSERT_TRUE(index.load("dipeptide.xtc"));
+    EXPECT_EQ(index.size() % 90, 0);
+    for (auto const& entry : std::filesystem::directory_iterator("."))
+    {
+        EXPECT_FALSE(entry.path().string().ends_with(".tmp")) << entry.path();
+    }
+
+    // Offsets that do not increase are corrupt
+    FrameIndex corrupt;
+    corrupt.add_frame(0, 180);
+    corrupt.add_frame(0, 180);
+    corrupt.save("dipeptide.xtc");
+    EXPECT_FALSE(index.load("dipeptide.xtc"));
+    EXPECT_EQ(index.size(), 0);
+
+    std::filesystem::remove(index_file);
+}
+
+TEST(Readers, MappedTrajectories) {
+    ASSERT_TRUE(DCDReader::can_read(".dcd"));
+    ASSERT_TRUE(BINPOSReader::can_read(".binpos"));
+    EXPECT_FALSE(DCDReader::can_read(".binpos"));
+    EXPECT_FALSE(BINPOSReader::can_read(".dcd"));
+    EXPECT_EQ(DCDReader().open("dipeptide.psf"), MolReader::FAILED);
+    EXPECT_EQ(BINPOSReader().open("dipeptide.psf"), MolReader::FAILED);
+
+    // Reference coordinates
+    MolfileReader psf_reader(".psf");
+    ASSERT_EQ(psf_reader.open("dipeptide.psf"), MolReader::SUCCESS);
+    auto data = psf_reader.read_atoms();
+    psf_reader.close();
+    ASSERT_THAT(data, NotNull());
+    EXPECT_EQ(MolfileReader(".xtc").read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 2);
+
+    for (std::string const ext : {".dcd", ".binpos"})
+    {
+        std::string const file_name = "dipeptide" + ext;
+        auto reader = MolReader::from_file_ext(ext);
+        ASSERT_THAT(reader, NotNull());
+        EXPECT_FALSE(reader->has_topology());
+        EXPECT_TRUE(reader->has_trajectory());
+        EXPECT_TRUE(reader->can_seek());
+        EXPECT_EQ(reader->check_timestep_read(*data), MolReader::INVALID);
+
+        // Plugins agree with native readers
+        EXPECT_EQ(MolfileReader(ext).read_trajectory(file_name, *data), MolReader::SUCCESS);
+        ASSERT_EQ(data->trajectory().num_frames(), 4);
+        EXPECT_THAT(data->trajectory().timestep(2).coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+        EXPECT_THAT(data->trajectory().timestep(3).coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+
+        // Random access, filling allocated timesteps
+        ASSERT_EQ(reader->open(file_name), MolReader::SUCCESS);
+        ASSERT_EQ(reader->check_timestep_read(*data), MolReader::SUCCESS);
+        Timestep ts(data->size());
+        ASSERT_EQ(reader->seek_timestep(1), MolReader::SUCCESS);
+        ASSERT_EQ(reader->read_timestep(ts), MolReader::SUCCESS);
+        EXPECT_FALSE(ts.is_view());
+        EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+        EXPECT_TRUE(ts.cell().lengths().isApprox(data->trajectory().timestep(3).cell().lengths(), 1e-4));
+        EXPECT_TRUE(ts.cell().angles().isApprox(data->trajectory().timestep(3).cell().angles(), 1e-4));
+        EXPECT_EQ(reader->read_timestep(ts), MolReader::END);
+        EXPECT_EQ(reader->seek_timestep(3), MolReader::END);
+
+        // Empty timesteps are allocated by the reader
+        Timestep empty;
+        ASSERT_EQ(reader->seek_timestep(0), MolReader::SUCCESS);
+        ASSERT_EQ(reader->read_timestep(empty), MolReader::SUCCESS);
+        EXPECT_EQ(empty.coords().cols(), data->size());
+        EXPECT_THAT(empty.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+        Timestep wrong(1);
+        EXPECT_EQ(reader->read_timestep(wrong), MolReader::WRONG_ATOMS);
+        reader->close();
+
+        // Views outlive the reader
+        EXPECT_EQ(empty.is_view(), ext == ".binpos");
+        EXPECT_THAT(empty.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+        empty.coords()(0, 0) = -1;
+        EXPECT_EQ(empty.coords()(0, 0), -1);
+
+        // Strided reads seek
+        EXPECT_EQ(reader->read_trajectory(file_name, *data, 1), MolReader::SUCCESS);
+        ASSERT_EQ(data->trajectory().num_frames(), 5);
+        EXPECT_THAT(data->trajectory().timestep(4).coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+
+        // Private mappings never change the file
+        Timestep again;
+        ASSERT_EQ(reader->open(file_name), MolReader::SUCCESS);
+        ASSERT_EQ(reader->read_timestep(again), MolReader::SUCCESS);
+        EXPECT_THAT(again.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+        reader->close();
+
+        data->trajectory() = Trajectory();
+        EXPECT_EQ(MolfileReader(".xtc").read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    }
+}
+
+TEST(Readers, TRR) {
+    ASSERT_TRUE(TRRReader::can_read(".trr"));
+    EXPECT_FALSE(TRRReader::can_read(".xtc"));
+    TRRReader reader;
+    EXPECT_FALSE(reader.has_topology());
+    EXPECT_TRUE(reader.has_trajectory());
+    EXPECT_TRUE(reader.can_seek());
+    EXPECT_EQ(reader.open("dipeptide.psf"), MolReader::FAILED);
+
+    // Reference coordinates
+    MolfileReader psf_reader(".psf");
+    ASSERT_EQ(psf_reader.open("dipeptide.psf"), MolReader::SUCCESS);
+    auto data = psf_reader.read_atoms();
+    psf_reader.close();
+    ASSERT_THAT(data, NotNull());
+    EXPECT_EQ(MolfileReader(".xtc").read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 2);
+
+    // Six frames alternating the reference ones
+    std::string const file_name = "dipeptide.trr";
+    std::vector<unsigned char> buffer;
+    trr::Header header {};
+    header.num_atoms = data->size();
+    for (size_t frame = 0; frame < 6; ++frame)
+    {
+        Timestep const& ts = data->trajectory().timestep(frame % 2);
+        Box3 const box = ts.cell().vectors();
+        header.step = frame;
+        trr::write_frame(header, box.data(), ts.coords().data(), buffer);
+    }
+    std::ofstream(file_name, std::ios::binary).write(reinterpret_cast<char const *>(buffer.data()), buffer.size());
+
+    // Plugins agree with the native reader
+    EXPECT_EQ(MolfileReader(".trr").read_trajectory(file_name, *data), MolReader::SUCCESS);
+    EXPECT_EQ(reader.read_trajectory(file_name, *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 14);
+    for (size_t frame = 2; frame < 14; ++frame)
+    {
+        Timestep const& expected = data->trajectory().timestep(frame % 2);
+        Timestep const& actual = data->trajectory().timestep(frame);
+        EXPECT_THAT(actual.coords().reshaped(), Pointwise(FloatNear(1e-3), expected.coords().reshaped()));
+        EXPECT_TRUE(actual.cell().lengths().isApprox(expected.cell().lengths(), 1e-4));
+    }
+
+    // Strided reads seek
+    data->trajectory() = Trajectory();
+    EXPECT_EQ(MolfileReader(".xtc").read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    EXPECT_EQ(reader.read_trajectory(file_name, *data, 1, -1, 2), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 5);
+    for (size_t frame = 2; frame < 5; ++frame)
+    {
+        EXPECT_THAT(data->trajectory().timestep(frame).coords().reshaped(), Pointwise(FloatNear(1e-3), data->trajectory().timestep(1).coords().reshaped()));
+    }
+    ASSERT_EQ(reader.open(file_name), MolReader::SUCCESS);
+    EXPECT_EQ(reader.seek_timestep(6), MolReader::SUCCESS);
+    Timestep ts;
+    EXPECT_EQ(reader.read_timestep(ts), MolReader::END);
+    EXPECT_EQ(reader.seek_timestep(7), MolReader::END);
+    reader.close();
+
+    // Frames without coordinates are not indexed
+    size_t const frame_size = buffer.size() / 6;
+    std::vector<unsigned char> velocities(buffer.begin(), buffer.begin() + frame_size);
+    std::swap_ranges(velocities.begin() + 52, velocities.begin() + 56, velocities.begin() + 56);
+    velocities.insert(velocities.end(), buffer.begin(), buffer.begin() + frame_size);
+    std::ofstream(file_name, std::ios::binary | std::ios::app).write(reinterpret_cast<char const *>(velocities.data()), velocities.size());
+    data->trajectory() = Trajectory();
+    EXPECT_EQ(reader.read_trajectory(file_name, *data), MolReader::SUCCESS);
+    EXPECT_EQ(data->trajectory().num_frames(), 7);
+
+    std::filesystem::remove(file_name);
+    std::filesystem::remove(FrameIndex::sidecar(file_name));
+}
+
+TEST(Readers, NativePDB) {
+    ASSERT_TRUE(PDBReader::can_read(".pdb"));
+    ASSERT_TRUE(PDBReader::can_read(".ent"));
+    EXPECT_FALSE(PDBReader::can_read(".gro"));
+    PDBReader reader;
+    EXPECT_TRUE(reader.has_topology());
+    EXPECT_TRUE(reader.has_trajectory());
+    EXPECT_TRUE(reader.has_bonds());
+    EXPECT_TRUE(reader.can_seek());
+    EXPECT_EQ(reader.open("dipeptide.dcd"), MolReader::FAILED);
+
+    for (std::string const file_name : {"4lad.pdb", "traj.pdb"})
+    {
+        auto data = reader.read_topology(file_name);
+        auto expected = MolfileReader(".pdb").read_topology(file_name);
+        ASSERT_THAT(data, NotNull());
+        ASSERT_THAT(expected, NotNull());
+        ASSERT_EQ(data->size(), expected->size());
+
+        AtomData const& atoms = data->atoms();
+        AtomData const& expected_atoms = expected->atoms();
+        for (index_t i = 0; i < data->size(); ++i)
+        {
+            EXPECT_EQ(atoms.name(i), expected_atoms.name(i));
+            EXPECT_EQ(atoms.type(i), expected_atoms.type(i));
+            EXPECT_EQ(atoms.altloc(i), expected_atoms.altloc(i));
+            EXPECT_EQ(atoms.atomic(i), expected_atoms.atomic(i));
+            EXPECT_FLOAT_EQ(atoms.occupancy(i), expected_atoms.occupancy(i));
+            EXPECT_FLOAT_EQ(atoms.tempfactor(i), expected_atoms.tempfactor(i));
+            EXPECT_EQ(atoms.residue(i), expected_atoms.residue(i));
+        }
+
+        ResidueData const& residues = data->residues();
+        ResidueData const& expected_residues = expected->residues();
+        ASSERT_EQ(residues.size(), expected_residues.size());
+        for (index_t i = 0; i < residues.size(); ++i)
+        {
+            EXPECT_EQ(residues.resid(i), expected_residues.resid(i));
+            EXPECT_EQ(residues.resname(i), expected_residues.resname(i));
+            EXPECT_EQ(residues.segid(i), expected_residues.segid(i));
+            EXPECT_EQ(residues.chain(i), expected_residues.chain(i));
+        }
+
+        EXPECT_EQ(data->bonds().size(), expected->bonds().size());
+        EXPECT_EQ(data->bonds().incomplete(), expected->bonds().incomplete());
+
+        EXPECT_EQ(reader.read_trajectory(file_name, *data), MolReader::SUCCESS);
+        EXPECT_EQ(MolfileReader(".pdb").read_trajectory(file_name, *expected), MolReader::SUCCESS);
+        ASSERT_EQ(data->trajectory().num_frames(), expected->trajectory().num_frames());
+        for (size_t frame = 0; frame < data->trajectory().num_frames(); ++frame)
+        {
+            Timestep const& ts = data->trajectory().timestep(frame);
+            Timestep const& expected_ts = expected->trajectory().timestep(frame);
+            EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(expected_ts.coords().reshaped()));
+
+            // Models without their own cell keep the one of the header
+            EXPECT_TRUE(ts.cell().lengths().isApprox(data->trajectory().timestep(0).cell().lengths()));
+            EXPECT_TRUE(ts.cell().angles().isApprox(data->trajectory().timestep(0).cell().angles()));
+        }
+        EXPECT_TRUE(data->trajectory().timestep(0).cell().lengths().isApprox(expected->trajectory().timestep(0).cell().lengths()));
+        EXPECT_TRUE(data->trajectory().timestep(0).cell().angles().isApprox(expected->trajectory().timestep(0).cell().angles()));
+    }
+
+    // Models are seekable
+    auto data = reader.read_topology("traj.pdb");
+    ASSERT_EQ(reader.read_trajectory("traj.pdb", *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 4);
+    Timestep ts(data->size());
+    ASSERT_EQ(reader.open("traj.pdb"), MolReader::SUCCESS);
+    ASSERT_EQ(reader.seek_timestep(2), MolReader::SUCCESS);
+    ASSERT_EQ(reader.read_timestep(ts), MolReader::SUCCESS);
+    EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(2).coords().reshaped()));
+    ASSERT_EQ(reader.seek_timestep(0), MolReader::SUCCESS);
+    ASSERT_EQ(reader.read_timestep(ts), MolReader::SUCCESS);
+    EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(0).coords().reshaped()));
+    EXPECT_EQ(reader.seek_timestep(5), MolReader::END);
+    reader.close();
+}
+
+TEST(Readers, NativeGRO) {
+    ASSERT_TRUE(GROReader::can_read(".gro"));
+    EXPECT_FALSE(GROReader::can_read(".pdb"));
+    GROReader reader;
+    EXPECT_TRUE(reader.has_topology());
+    EXPECT_TRUE(reader.has_trajectory());
+    EXPECT_FALSE(reader.has_bonds());
+    EXPECT_TRUE(reader.can_seek());
+
+    std::string const file_name = "native.gro";
+    {
+        std::ofstream file(file_name);
+        file << "Two waters t= 1.50000\n"
+             << "    6\n"
+             << "    1SOL     OW    1   0.126   1.624   1.679\n"
+             << "    1SOL    HW1    2   0.190   1.661   1.747\n"
+             << "    1SOL    HW2    3   0.177   1.568   1.613\n"
+             << "    2SOL     OW    4   1.275   0.053   0.622\n"
+             << "    2SOL    HW1    5   1.337   0.002   0.680\n"
+             << "    2SOL    HW2    6   1.326   0.120   0.568\n"
+             << "   1.86206   1.86206   1.86206\n"
+             << "Two waters t= 3.00000\n"
+             << "    6\n"
+             << "    1SOL     OW    1   0.226   1.624   1.679\n"
+             << "    1SOL    HW1    2   0.290   1.661   1.747\n"
+             << "    1SOL    HW2    3   0.277   1.568   1.613\n"
+             << "    2SOL     OW    4   1.375   0.053   0.622\n"
+             << "    2SOL    HW1    5   1.437   0.002   0.680\n"
+             << "    2SOL    HW2    6   1.426   0.120   0.568\n"
+             << "   1.86206   1.86206   1.86206   0.00000   0.00000   0.93103   0.00000   0.93103   0.93103\n";
+    }
+
+    // The plugin only reads frames after the structure
+    auto data = reader.read_topology(file_name);
+    MolfileReader molfile_reader(".gro");
+    ASSERT_EQ(molfile_reader.open(file_name), MolReader::SUCCESS);
+    auto expected = molfile_reader.read_atoms();
+    ASSERT_THAT(data, NotNull());
+    ASSERT_THAT(expected, NotNull());
+    ASSERT_EQ(data->size(), 6);
+    ASSERT_EQ(data->residues().size(), 2);
+    for (index_t i = 0; i < data->size(); ++i)
+    {
+        EXPECT_EQ(data->atoms().name(i), expected->atoms().name(i));
+        EXPECT_EQ(data->atoms().residue(i), expected->atoms().residue(i));
+    }
+    EXPECT_EQ(data->residues().resid(1), 2);
+    EXPECT_EQ(data->residues().resname(1), "SOL");
+
+    EXPECT_EQ(reader.read_trajectory(file_name, *data), MolReader::SUCCESS);
+    EXPECT_EQ(molfile_reader.read_timestep(*expected), MolReader::SUCCESS);
+    EXPECT_EQ(molfile_reader.read_timestep(*expected), MolReader::SUCCESS);
+    molfile_reader.close();
+    ASSERT_EQ(data->trajectory().num_frames(), 2);
+    ASSERT_EQ(expected->trajectory().num_frames(), 2);
+    for (size_t frame = 0; frame < 2; ++frame)
+    {
+        Timestep const& ts = data->trajectory().timestep(frame);
+        Timestep const& expected_ts = expected->trajectory().timestep(frame);
+        EXPECT_TRUE(ts.coords().isApprox(expected_ts.coords()));
+        EXPECT_TRUE(ts.cell().lengths().isApprox(expected_ts.cell().lengths(), 1e-4));
+        EXPECT_TRUE(ts.cell().angles().isApprox(expected_ts.cell().angles(), 1e-4));
+    }
+    EXPECT_FLOAT_EQ(data->trajectory().timestep(0).time(), 1.5);
+    EXPECT_LT(data->trajectory().timestep(1).cell().angles()[0], 90);
+
+    // Times are read from the titles without decoding frames
+    double time = 0;
+    ASSERT_EQ(reader.open(file_name), MolReader::SUCCESS);
+    EXPECT_TRUE(reader.frame_time(1, time));
+    EXPECT_FLOAT_EQ(time, 3);
+    EXPECT_FALSE(reader.frame_time(2, time));
+    reader.close();
+
+    // Truncated frames end the trajectory
+    {
+        std::ofstream file(file_name, std::ios::app);
+        file << "Truncated\n"
+             << "    6\n"
+             << "    1SOL     OW    1   0.226   1.624   1.679\n";
+    }
+    EXPECT_EQ(reader.read_trajectory(file_name, *data), MolReader::SUCCESS);
+    EXPECT_EQ(data->trajectory().num_frames(), 4);
+
+    std::filesystem::remove(file_name);
+}
+
+TEST(Readers, PrefetchTrajectory) {
+    MolfileReader psf_reader(".psf");
+    ASSERT_EQ(psf_reader.open("dipeptide.psf"), MolReader::SUCCESS);
+    auto data = psf_reader.read_atoms();
+    psf_reader.close();
+    ASSERT_THAT(data, NotNull());
+    EXPECT_EQ(XTCReader().read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    EXPECT_EQ(XTCReader().read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 4);
+
+    for (size_t const depth : {1, 2, 8})
+    {
+        std::vector<size_t> frames;
+        auto reader = MolReader::from_file_ext(".xtc");
+        EXPECT_EQ(reader->stream_trajectory("dipeptide.xtc", *data, [&](size_t const frame, Timestep &ts)
+        {
+            EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(frame).coords().reshaped()));
+            frames.push_back(frame);
+            return true;
+        }, 0, -1, 1, depth), MolReader::SUCCESS);
+        EXPECT_THAT(frames, ElementsAre(0, 1));
+
+        // Early stops and strides
+        frames.clear();
+        EXPECT_EQ(reader->stream_trajectory("dipeptide.xtc", *data, [&](size_t const frame, Timestep&)
+        {
+            frames.push_back(frame);
+            return false;
+        }, 1, -1, 1, depth), MolReader::SUCCESS);
+        EXPECT_THAT(frames, ElementsAre(1));
+
+        // Consumer errors stop the producer
+        EXPECT_THROW(reader->stream_trajectory("dipeptide.xtc", *data, [](size_t const, Timestep&) -> bool
+        {
+            throw MolError("consumer");
+        }, 0, -1, 1, depth), MolError);
+        EXPECT_EQ(reader->open("dipeptide.xtc"), MolReader::SUCCESS);
+        reader->close();
+    }
+
+    // Producer errors are thrown to the consumer
+    class FailingReader : public XTCReader
+    {
+    public:
+        size_t batch_size() const override { return 1; }
+        Status read_timestep(Timestep&) override { throw MolError("producer"); }
+    };
+    FailingReader failing;
+    EXPECT_THROW(failing.stream_trajectory("dipeptide.xtc", *data, [](size_t const, Timestep&) { return true; }, 0, -1, 1, 2), MolError);
+    EXPECT_EQ(failing.open("dipeptide.xtc"), MolReader::SUCCESS);
+    failing.close();
+
+    // Wrong systems are rejected before starting
+    MolData wrong(1);
+    EXPECT_EQ(XTCReader().stream_trajectory("dipeptide.xtc", wrong, [](size_t const, Timestep&) { return true; }, 0, -1, 1, 2), MolReader::WRONG_ATOMS);
+}
+
+TEST(Readers, ReadAhead) {
+    ReadAhead read_ahead(256);
+    EXPECT_FALSE(read_ahead.open("missing.xtc"));
+    ASSERT_TRUE(read_ahead.open("dipeptide.dcd"));
+    uint64_t const size = std::filesystem::file_size("dipeptide.dcd");
+    ASSERT_GT(size, 512);
+
+    // Reads within the first half of the window request nothing new
+    read_ahead.access(0, 50);
+    EXPECT_EQ(read_ahead.requested(), 256);
+    read_ahead.access(50, 50);
+    EXPECT_EQ(read_ahead.requested(), 256);
+
+    // Past half of it, the window moves forward
+    read_ahead.access(150, 50);
+    EXPECT_EQ(read_ahead.requested(), 150 + 256);
+
+    // Jumps request from the new offset, never past the end
+    read_ahead.access(size - 10, 10);
+    EXPECT_EQ(read_ahead.requested(), size);
+    read_ahead.access(0, 10);
+    EXPECT_EQ(read_ahead.requested(), 256);
+
+    // Large reads extend the window
+    read_ahead.access(0, 512);
+    EXPECT_EQ(read_ahead.requested(), 512);
+    read_ahead.close();
+    EXPECT_EQ(read_ahead.requested(), 0);
+}
+
 TEST(Readers, MolReader) {
     EXPECT_THAT(MolReader::from_file_ext(".unk"), IsNull());
     EXPECT_THAT(MolReader::from_file_ext(".pdb"), NotNull());
@@ -337,3 +901,118 @@ TEST(Readers, MolReader) {
     EXPECT_EQ(pdb_reader->read_trajectory("traj.pdb", *atoms, -2, 0, 2), MolReader::SUCCESS);
     EXPECT_EQ(atoms->trajectory().num_frames(), 6);
 }
+
+TEST(Readers, Snapshot) {
+    ASSERT_TRUE(SnapshotReader::can_read(".molpp"));
+    EXPECT_FALSE(SnapshotReader::can_read(".pdb"));
+    SnapshotReader reader;
+    EXPECT_TRUE(reader.has_topology());
+    EXPECT_TRUE(reader.has_trajectory());
+    EXPECT_TRUE(reader.has_bonds());
+    EXPECT_TRUE(reader.can_seek());
+    EXPECT_THROW(reader.read_atoms(), MolError); // Not open
+    EXPECT_EQ(reader.open("dipeptide.psf"), MolReader::FAILED);
+
+    MolfileReader psf_reader(".psf");
+    ASSERT_EQ(psf_reader.open("dipeptide.psf"), MolReader::SUCCESS);
+    auto data = psf_reader.read_atoms();
+    psf_reader.close();
+    ASSERT_THAT(data, NotNull());
+    EXPECT_EQ(MolfileReader(".xtc").read_trajectory("dipeptide.xtc", *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 2);
+    data->trajectory().timestep(1).time() = 2.5;
+    data->atoms().altloc(3) = "B";
+    auto bond = data->bonds().add_bond(0, 5);
+    ASSERT_THAT(bond, NotNull());
+    bond->set_order(2);
+    bond->set_guessed(false);
+    bond->set_aromatic(true);
+
+    std::string const file_name = "dipeptide.molpp";
+    ASSERT_TRUE(snapshot::write(*data, file_name, true));
+    ASSERT_EQ(reader.open(file_name), MolReader::SUCCESS);
+    ASSERT_EQ(reader.open(file_name), MolReader::INVALID); // Re-open
+    auto loaded = reader.read_atoms();
+    ASSERT_THAT(loaded, NotNull());
+    ASSERT_EQ(loaded->size(), data->size());
+
+    // Atoms
+    for (index_t i = 0; i < data->size(); ++i)
+    {
+        EXPECT_EQ(loaded->atoms().residue(i), data->atoms().residue(i));
+        EXPECT_EQ(loaded->atoms().atomic(i), data->atoms().atomic(i));
+        EXPECT_EQ(loaded->atoms().occupancy(i), data->atoms().occupancy(i));
+        EXPECT_EQ(loaded->atoms().tempfactor(i), data->atoms().tempfactor(i));
+        EXPECT_EQ(loaded->atoms().mass(i), data->atoms().mass(i));
+        EXPECT_EQ(loaded->atoms().charge(i), data->atoms().charge(i));
+        EXPECT_EQ(loaded->atoms().radius(i), data->atoms().radius(i));
+        EXPECT_EQ(loaded->atoms().name(i), data->atoms().name(i));
+        EXPECT_EQ(loaded->atoms().type(i), data->atoms().type(i));
+        EXPECT_EQ(loaded->atoms().altloc(i), data->atoms().altloc(i));
+    }
+
+    // Residues
+    ASSERT_EQ(loaded->residues().size(), data->residues().size());
+    for (index_t i = 0; i < data->residues().size(); ++i)
+    {
+        EXPECT_EQ(loaded->residues().resid(i), data->residues().resid(i));
+        EXPECT_EQ(loaded->residues().resname(i), data->residues().resname(i));
+        EXPECT_EQ(loaded->residues().segid(i), data->residues().segid(i));
+        EXPECT_EQ(loaded->residues().chain(i), data->residues().chain(i));
+        auto const expected = data->residues().indices(i);
+        auto const actual = loaded->residues().indices(i);
+        EXPECT_THAT(std::vector<index_t>(actual.begin(), actual.end()), UnorderedElementsAreArray(expected.begin(), expected.end()));
+    }
+
+    // Bonds
+    EXPECT_EQ(loaded->bonds().incomplete(), data->bonds().incomplete());
+    ASSERT_EQ(loaded->bonds().size(), data->bonds().size());
+    for (auto const& expected : data->bonds().bonds())
+    {
+        auto const actual = loaded->bonds().bond(expected->atom1(), expected->atom2());
+        ASSERT_THAT(actual, NotNull());
+        EXPECT_EQ(actual->order(), expected->order());
+        EXPECT_EQ(actual->guessed(), expected->guessed());
+        EXPECT_EQ(actual->guessed_order(), expected->guessed_order());
+        EXPECT_EQ(actual->aromatic(), expected->aromatic());
+    }
+    reader.close();
+
+    // Frames are views of the file
+    EXPECT_EQ(reader.read_trajectory(file_name, *loaded), MolReader::SUCCESS);
+    ASSERT_EQ(loaded->trajectory().num_frames(), 2);
+    for (size_t frame = 0; frame < 2; ++frame)
+    {
+        Timestep const& expected = data->trajectory().timestep(frame);
+        Timestep const& actual = loaded->trajectory().timestep(frame);
+        EXPECT_TRUE(actual.is_view());
+        EXPECT_THAT(actual.coords().reshaped(), ElementsAreArray(expected.coords().reshaped()));
+        EXPECT_EQ(actual.cell().lengths(), expected.cell().lengths());
+        EXPECT_EQ(actual.cell().angles(), expected.cell().angles());
+        EXPECT_EQ(actual.time(), expected.time());
+    }
+    double time = 0;
+    ASSERT_EQ(reader.open(file_name), MolReader::SUCCESS);
+    EXPECT_TRUE(reader.frame_time(1, time));
+    EXPECT_EQ(time, data->trajectory().timestep(1).time());
+    EXPECT_FALSE(reader.frame_time(2, time));
+    reader.close();
+    Timestep ts(data->size());
+    ASSERT_EQ(reader.open(file_name), MolReader::SUCCESS);
+    ASSERT_EQ(reader.seek_timestep(1), MolReader::SUCCESS);
+    ASSERT_EQ(reader.read_timestep(ts), MolReader::SUCCESS);
+    EXPECT_FALSE(ts.is_view());
+    EXPECT_THAT(ts.coords().reshaped(), ElementsAreArray(data->trajectory().timestep(1).coords().reshaped()));
+    EXPECT_EQ(reader.read_timestep(ts), MolReader::END);
+    reader.close();
+
+    // Topology-only snapshots add no frames
+    ASSERT_TRUE(snapshot::write(*data, file_name, false));
+    EXPECT_EQ(reader.read_trajectory(file_name, *loaded), MolReader::SUCCESS);
+    EXPECT_EQ(loaded->trajectory().num_frames(), 2);
+
+    // Truncated files are rejected
+    std::filesystem::resize_file(file_name, std::filesystem::file_size(file_name) - 8);
+    EXPECT_EQ(reader.open(file_name), MolReader::FAILED);
+    std::filesystem::remove(file_name);
+}
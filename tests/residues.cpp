@@ -177,3 +177,31 @@ TEST(Residues, ResidueDetect) {
     EXPECT_THAT(view2vector<index_t>(residues_data.indices(3)), UnorderedElementsAre(3, 9));
     EXPECT_THAT(view2vector<index_t>(residues_data.indices(4)), UnorderedElementsAre(4, 6));
 }
+
+TEST(Residues, ResidueDetectMany) {
+    // Enough residues to grow the table several times, each one
+    // registered twice and out of order the second time
+    size_t const num_residues = 5000;
+    ResidueDetect detect;
+    MolData data(2 * num_residues);
+    for (index_t i = 0; i < num_residues; i++)
+    {
+        std::string const chain(1, 'A' + i % 26);
+        data.atoms().residue(i) = detect.register_atom(i / 26, "RES", "", chain);
+    }
+    for (index_t i = 0; i < num_residues; i++)
+    {
+        index_t const residue = num_residues - 1 - i;
+        std::string const chain(1, 'A' + residue % 26);
+        data.atoms().residue(num_residues + i) = detect.register_atom(residue / 26, "RES", "", chain);
+        ASSERT_EQ(data.atoms().residue(num_residues + i), residue);
+    }
+    EXPECT_EQ(detect.size(), num_residues);
+
+    detect.update_residue_data(data);
+    ResidueData &residues_data = data.residues();
+    ASSERT_EQ(residues_data.size(), num_residues);
+    EXPECT_EQ(residues_data.resid(27), 1);
+    EXPECT_EQ(residues_data.chain(27), "B");
+    EXPECT_THAT(view2vector<index_t>(residues_data.indices(27)), UnorderedElementsAre(27, 2 * num_residues - 28));
+}
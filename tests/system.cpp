@@ -2,12 +2,18 @@
 #include <molpp/MolError.hpp>
 #include <molpp/MolSystem.hpp>
 #include <molpp/AtomSelector.hpp>
+#include <molpp/TrajectoryWriter.hpp>
+#include <molpp/QuantizedTimestep.hpp>
 #include "core/MolData.hpp"
+#include "readers/MolfileReader.hpp"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <filesystem>
 
 using namespace mol;
 using namespace testing;
+using mol::internal::MolReader;
+using mol::internal::MolfileReader;
 
 TEST(System, MolSystem) {
     EXPECT_THROW(MolSystem(""), MolError);
@@ -108,3 +114,440 @@ TEST(System, Bonds) {
     bond = atoms[1791].bond(1407); // HIS361B-ND1-ZN701B
     EXPECT_THAT(bond, NotNull());
 }
+
+TEST(System, GuessBondsSubset) {
+    MolSystem mol("4lad.pdb");
+    mol.add_trajectory("4lad.pdb", mol.select(std::vector<index_t> {1407, 1791}));
+    mol.reset_bonds();
+
+    // Distances are only known between the atoms with coordinates
+    mol.guess_bonds(0);
+    AtomSel atoms = mol.atoms();
+    EXPECT_THAT(atoms[1791].bond(1407), NotNull()); // HIS361B-ND1-ZN701B
+    EXPECT_THAT(atoms[650].bond(648), NotNull()); // TYR80A-CZ-CE1
+    EXPECT_THAT(atoms[1108].bond(1101), IsNull()); // PHE151A-N-GLN150A-C
+}
+
+TEST(System, LazyTrajectory) {
+    MolSystem mol("traj.pdb");
+    EXPECT_THROW(mol.add_lazy_trajectory("traj.unk"), MolError);
+    EXPECT_THROW(mol.add_lazy_trajectory("tiny.pdb"), MolError);
+    EXPECT_THROW(mol.add_lazy_trajectory("no_file.pdb"), MolError);
+
+    mol.add_trajectory("traj.pdb");
+    mol.add_lazy_trajectory("traj.pdb");
+    mol.add_lazy_trajectory("traj.pdb", 1, -1, 2);
+    ASSERT_EQ(mol.atoms(0).frame(), 0);
+    ASSERT_EQ(mol.atoms(9).frame(), 9);
+    EXPECT_THROW(mol.atoms(10), MolError);
+
+    // Random access, including backward seeks
+    for (size_t const frame : {7, 4, 9, 5, 8, 6})
+    {
+        AtomSel eager = mol.atoms((frame < 8) ? frame - 4 : 2 * (frame - 8) + 1);
+        AtomSel lazy = mol.atoms(frame);
+        EXPECT_THAT(lazy.coords().reshaped(), ElementsAreArray(eager.coords().reshaped()));
+    }
+}
+
+TEST(System, LazyTrajectories) {
+    MolSystem mol("traj.pdb");
+    EXPECT_THROW(mol.add_lazy_trajectories({"traj.pdb", "traj.unk"}), MolError);
+    EXPECT_THROW(mol.atoms(0), MolError);
+
+    mol.add_lazy_trajectories({"traj.pdb", "traj.pdb", "traj.pdb"}, 1, -1, 2);
+    EXPECT_THROW(mol.atoms(6), MolError);
+
+    MolSystem reference("traj.pdb");
+    reference.add_trajectory("traj.pdb");
+    for (size_t const frame : {5, 0, 3, 2, 4, 1})
+    {
+        EXPECT_THAT(mol.atoms(frame).coords().reshaped(), ElementsAreArray(reference.atoms(2 * (frame % 2) + 1).coords().reshaped()));
+    }
+}
+
+TEST(System, TrajectoryCache) {
+    MolSystem reference("traj.pdb");
+    reference.add_trajectory("traj.pdb");
+
+    // Two frames of two atoms
+    MolSystem mol("traj.pdb");
+    mol.set_trajectory_cache(2 * 2 * 3 * sizeof(position_t));
+    mol.add_lazy_trajectory("traj.pdb");
+    for (size_t const frame : {0, 1, 0, 2, 0, 1, 3})
+    {
+        EXPECT_THAT(mol.atoms(frame).coords().reshaped(), ElementsAreArray(reference.atoms(frame).coords().reshaped()));
+    }
+
+    FrameCacheStats stats = mol.trajectory_cache_stats();
+    EXPECT_EQ(stats.misses, 5);
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.evictions, 3);
+    EXPECT_EQ(stats.bytes, 2 * 2 * 3 * sizeof(position_t));
+
+    // Frames done are evicted first
+    mol.atoms(2).coords();
+    mol.mark_frame_done(2);
+    mol.atoms(0).coords();
+    mol.atoms(3).coords();
+    stats = mol.trajectory_cache_stats();
+    EXPECT_EQ(stats.misses, 7);
+    EXPECT_EQ(stats.hits, 3);
+    EXPECT_EQ(stats.evictions, 5);
+
+    // Frames evicted while transposing are kept
+    TimeSeries const series = mol.atoms().time_series();
+    TimeSeries const expected = reference.atoms().time_series();
+    EXPECT_THAT(series.reshaped(), ElementsAreArray(expected.reshaped()));
+
+    mol.set_trajectory_cache(0);
+    for (size_t frame = 0; frame < 4; ++frame)
+    {
+        mol.atoms(frame).coords();
+    }
+    EXPECT_EQ(mol.trajectory_cache_stats().bytes, 4 * 2 * 3 * sizeof(position_t));
+
+    // Changed frames are kept when evicted, since files are not written
+    MolSystem changed("traj.pdb");
+    changed.set_trajectory_cache(2 * 2 * 3 * sizeof(position_t));
+    changed.add_lazy_trajectory("traj.pdb");
+    changed.atoms(0).coords()(0, 0) = 42;
+    for (size_t const frame : {1, 2, 3})
+    {
+        changed.atoms(frame).coords();
+    }
+    EXPECT_EQ(changed.atoms(0).coords()(0, 0), 42);
+    EXPECT_EQ(changed.trajectory_cache_stats().evictions, 2);
+}
+
+TEST(System, CompressedTrajectory) {
+    MolSystem mol("traj.pdb");
+    mol.add_trajectory("traj.pdb");
+    mol.set_trajectory_compression(0.01);
+    mol.add_trajectory("traj.pdb");
+    mol.add_lazy_trajectory("traj.pdb");
+    EXPECT_THROW(mol.atoms(12), MolError);
+
+    for (size_t const frame : {6, 5, 7, 4})
+    {
+        Coord3 const expected = mol.atoms(frame - 4).coords();
+        Coord3 const compressed = mol.atoms(frame).coords();
+        EXPECT_LE((compressed - expected).cwiseAbs().maxCoeff(), 0.005);
+        EXPECT_THAT(mol.atoms(frame + 4).coords().reshaped(), ElementsAreArray(expected.reshaped()));
+    }
+}
+
+TEST(System, QuantizedTrajectory) {
+    MolSystem mol("traj.pdb");
+    mol.add_trajectory("traj.pdb");
+    mol.set_trajectory_quantization(true);
+    mol.add_trajectory("traj.pdb");
+
+    for (size_t const frame : {2, 1, 3, 0})
+    {
+        Coord3 const expected = mol.atoms(frame).coords();
+        AtomSel const atoms = mol.atoms(frame + 4);
+        Coord3 const quantized = atoms.coords();
+        EXPECT_LE((quantized - expected).cwiseAbs().maxCoeff(), QuantizedTimestep::TOLERANCE);
+        Atom const atom = mol.atoms(frame + 4)[1];
+        EXPECT_EQ(Point3(atom.coords()), Point3(quantized.col(1)));
+    }
+
+    // Changes are quantized again
+    mol.atoms(4).coords();
+    mol.atoms(4).timestep().coords()(0, 0) = 1.5;
+    EXPECT_NEAR(mol.atoms(5).timestep().coords()(0, 0), mol.atoms(1).timestep().coords()(0, 0), QuantizedTimestep::TOLERANCE);
+    EXPECT_NEAR(mol.atoms(4).timestep().coords()(0, 0), 1.5, QuantizedTimestep::TOLERANCE);
+}
+
+TEST(System, ChunkedTrajectory) {
+    MolSystem mol("traj.pdb");
+    mol.add_trajectory("traj.pdb");
+    mol.set_trajectory_chunk(3);
+    mol.add_trajectory("traj.pdb");
+    mol.add_trajectories({"traj.pdb"});
+
+    for (size_t frame = 0; frame < 4; ++frame)
+    {
+        Coord3 const expected = mol.atoms(frame).coords();
+        EXPECT_THAT(mol.atoms(frame + 4).coords().reshaped(), ElementsAreArray(expected.reshaped()));
+        EXPECT_THAT(mol.atoms(frame + 8).coords().reshaped(), ElementsAreArray(expected.reshaped()));
+        EXPECT_TRUE(mol.atoms(frame + 4).timestep().is_view());
+    }
+}
+
+TEST(System, TimeSeries) {
+    MolSystem reference("traj.pdb");
+    reference.add_trajectory("traj.pdb");
+
+    MolSystem mol("traj.pdb");
+    mol.add_trajectory("traj.pdb", mol.select(std::vector<index_t> {1}));
+    EXPECT_THROW(mol.atoms().time_series(), MolError);
+
+    // One column per atom, frames after frames
+    AtomSel atoms = mol.select(std::vector<index_t> {1});
+    AtomSel::time_series_type series = atoms.time_series();
+    ASSERT_EQ(series.rows(), 12);
+    ASSERT_EQ(series.cols(), 1);
+    for (size_t frame = 0; frame < 4; ++frame)
+    {
+        EXPECT_THAT(series.col(0).segment(3 * frame, 3), ElementsAreArray(reference.atoms(frame)[1].coords().reshaped()));
+    }
+}
+
+TEST(System, StreamTrajectory) {
+    MolSystem mol("traj.pdb");
+    auto ignore = [](size_t const, Timestep&) { return true; };
+    EXPECT_THROW(mol.stream_trajectory("traj.unk", ignore), MolError);
+    EXPECT_THROW(mol.stream_trajectory("tiny.pdb", ignore), MolError);
+    EXPECT_THROW(mol.stream_trajectory("no_file.pdb", ignore), MolError);
+
+    // Nothing is stored and the buffer is reused
+    std::vector<size_t> frames;
+    std::vector<std::vector<position_t>> coords;
+    position_t const *buffer = nullptr;
+    mol.stream_trajectory("traj.pdb", [&](size_t const frame, Timestep &ts)
+    {
+        if (!buffer)
+        {
+            buffer = ts.coords().data();
+        }
+        EXPECT_EQ(ts.coords().data(), buffer);
+        frames.push_back(frame);
+        coords.emplace_back(ts.coords().data(), ts.coords().data() + ts.coords().size());
+        return true;
+    });
+    EXPECT_THROW(mol.atoms(0), MolError);
+    EXPECT_THAT(frames, ElementsAre(0, 1, 2, 3));
+
+    mol.add_trajectory("traj.pdb");
+    for (size_t const frame : frames)
+    {
+        EXPECT_THAT(mol.atoms(frame).coords().reshaped(), ElementsAreArray(coords[frame]));
+    }
+
+    // Strides and early stops
+    frames.clear();
+    mol.stream_trajectory("traj.pdb", [&](size_t const frame, Timestep&)
+    {
+        frames.push_back(frame);
+        return true;
+    }, 1, -1, 2);
+    EXPECT_THAT(frames, ElementsAre(1, 3));
+
+    frames.clear();
+    mol.stream_trajectory("traj.pdb", [&](size_t const frame, Timestep&)
+    {
+        frames.push_back(frame);
+        return frame < 1;
+    });
+    EXPECT_THAT(frames, ElementsAre(0, 1));
+}
+
+TEST(System, ResetTrajectory) {
+    MolSystem mol("traj.pdb");
+    mol.add_trajectory("traj.pdb");
+    std::vector<position_t const *> buffers;
+    std::vector<std::vector<position_t>> coords;
+    for (size_t frame = 0; frame < 4; ++frame)
+    {
+        Coord3 const ts_coords = mol.atoms(frame).coords();
+        buffers.push_back(&mol.atoms(frame).coords()(0, 0));
+        coords.emplace_back(ts_coords.data(), ts_coords.data() + ts_coords.size());
+    }
+
+    mol.reset_trajectory();
+    EXPECT_THROW(mol.atoms(0), MolError);
+
+    // Re-reading recycles the frame buffers
+    mol.add_trajectory("traj.pdb");
+    for (size_t frame = 0; frame < 4; ++frame)
+    {
+        EXPECT_THAT(buffers, Contains(&mol.atoms(frame).coords()(0, 0)));
+        EXPECT_THAT(mol.atoms(frame).coords().reshaped(), ElementsAreArray(coords[frame]));
+    }
+
+    mol.reset_trajectory(false);
+    mol.add_lazy_trajectory("traj.pdb");
+    EXPECT_THAT(mol.atoms(3).coords().reshaped(), ElementsAreArray(coords[3]));
+}
+
+TEST(System, AddTrajectories) {
+    MolSystem mol("traj.pdb");
+    EXPECT_THROW(mol.add_trajectories({"traj.pdb", "traj.unk"}), MolError);
+    EXPECT_THROW(mol.add_trajectories({"tiny.pdb", "traj.pdb"}), MolError);
+    EXPECT_THROW(mol.atoms(0), MolError);
+    mol.add_trajectories({});
+
+    // Segments are kept in order
+    std::vector<std::string> const segments {"traj.pdb", "traj.pdb", "traj.pdb"};
+    mol.add_trajectories(segments, 1, -1, 2, 2);
+    mol.add_trajectories(segments);
+    EXPECT_THROW(mol.atoms(18), MolError);
+
+    MolSystem reference("traj.pdb");
+    reference.add_trajectory("traj.pdb");
+    for (size_t frame = 0; frame < 18; ++frame)
+    {
+        size_t const ref_frame = (frame < 6) ? 2 * (frame % 2) + 1 : (frame - 6) % 4;
+        EXPECT_THAT(mol.atoms(frame).coords().reshaped(), ElementsAreArray(reference.atoms(ref_frame).coords().reshaped()));
+    }
+}
+
+TEST(System, ReaderStats) {
+    MolSystem mol("dipeptide.psf");
+    EXPECT_EQ(mol.reader_stats().frames_decoded, 0);
+
+    mol.add_trajectory("dipeptide.xtc", 1);
+    ReaderStats stats = mol.reader_stats();
+    EXPECT_EQ(stats.frames_decoded, 1);
+    EXPECT_EQ(stats.frames_skipped, 1);
+    EXPECT_GE(stats.bytes_read, 180);
+    EXPECT_GE(stats.peak_buffer_bytes, 180);
+    EXPECT_GE(stats.io_time, 0);
+    EXPECT_GE(stats.decode_time, 0);
+    EXPECT_THAT(stats.json(), StartsWith("{\"bytes_read\": "));
+    EXPECT_THAT(stats.json(), HasSubstr("\"frames_decoded\": 1, \"frames_skipped\": 1,"));
+
+    // Segments add up
+    mol.add_trajectories({"dipeptide.dcd", "dipeptide.binpos"});
+    stats = mol.reader_stats();
+    EXPECT_EQ(stats.frames_decoded, 4);
+    EXPECT_EQ(stats.frames_skipped, 0);
+    EXPECT_GE(stats.bytes_read, 4 * 12 * mol.atoms().size());
+
+    // Frames waiting to be consumed count as buffers
+    mol.stream_trajectory("dipeptide.xtc", [](size_t const, Timestep&) { return true; }, 0, -1, 1, 2);
+    EXPECT_GE(mol.reader_stats().peak_buffer_bytes, 2 * 3 * mol.atoms().size() * sizeof(position_t));
+
+    // Lazy frames are counted when read
+    mol.reset_trajectory();
+    mol.add_lazy_trajectory("dipeptide.xtc");
+    EXPECT_EQ(mol.reader_stats().frames_decoded, 0);
+    mol.atoms(1).coords();
+    EXPECT_EQ(mol.reader_stats().frames_decoded, 1);
+}
+
+TEST(System, AtomSubsetTrajectory) {
+    MolSystem reference("traj.pdb");
+    reference.add_trajectory("traj.pdb");
+
+    std::vector<index_t> const subset {1};
+    MolSystem mol("traj.pdb");
+    mol.add_trajectory("traj.pdb", mol.select(subset));
+    mol.add_lazy_trajectory("traj.pdb");
+    mol.add_trajectories({"traj.pdb"});
+    EXPECT_THROW(mol.add_trajectory("traj.pdb", mol.select(std::vector<index_t> {0})), MolError);
+    EXPECT_THROW(mol.save("subset.molpp", true), MolError);
+    EXPECT_THROW(mol.atoms(12), MolError);
+
+    // Only the selected atoms have coordinates
+    for (size_t frame = 0; frame < 12; ++frame)
+    {
+        AtomSel atoms = mol.select(subset, frame);
+        EXPECT_EQ(atoms.timestep().coords().cols(), 1);
+        EXPECT_THAT(atoms.coords().reshaped(), ElementsAreArray(reference.select(subset, frame % 4).coords().reshaped()));
+        EXPECT_THAT(atoms[0].coords().reshaped(), ElementsAreArray(reference.atoms(frame % 4)[1].coords().reshaped()));
+        EXPECT_THROW(mol.atoms(frame).coords(), MolError);
+        EXPECT_THROW(mol.atoms(frame)[0].coords(), MolError);
+    }
+
+    mol.reset_trajectory();
+    mol.add_trajectory("traj.pdb", mol.atoms());
+    EXPECT_THAT(mol.atoms(3).coords().reshaped(), ElementsAreArray(reference.atoms(3).coords().reshaped()));
+}
+
+TEST(System, TrajectoryTimes) {
+    MolSystem mol("traj.pdb");
+    mol.add_trajectory("traj.pdb");
+    EXPECT_EQ(mol.frame_time(3), 0);
+    EXPECT_THROW(mol.frame_time(4), MolError);
+
+    // Output interval changes after frame 9
+    std::vector<double> times;
+    for (size_t frame = 0; frame < 15; ++frame)
+    {
+        times.push_back((frame < 10) ? 2.0 * frame : 18 + 5.0 * (frame - 9));
+    }
+    for (std::string const file_name : {"times.xtc", "times.trr"})
+    {
+        TrajectoryWriter writer(file_name, mol.atoms());
+        for (size_t frame = 0; frame < times.size(); ++frame)
+        {
+            Timestep ts(2);
+            ts.coords().setConstant(frame);
+            ts.time() = times[frame];
+            writer.write(ts);
+        }
+    }
+
+    for (std::string const file_name : {"times.xtc", "times.trr"})
+    {
+        MolSystem timed("traj.pdb");
+        timed.add_trajectory_times(file_name, 3, 30, 4);
+        EXPECT_EQ(timed.frame_at(0), 0);
+        EXPECT_EQ(timed.frame_at(17), 4);
+        EXPECT_EQ(timed.frame_at(28), 5);
+        EXPECT_EQ(timed.frame_at(29), std::nullopt);
+
+        timed.add_trajectory_times(file_name, 10, 23);
+        EXPECT_THROW(timed.atoms(12), MolError);
+        std::vector<size_t> const frames {2, 4, 6, 8, 10, 11, 5, 6, 7, 8, 9, 10};
+        for (size_t i = 0; i < frames.size(); ++i)
+        {
+            EXPECT_FLOAT_EQ(timed.frame_time(i), times[frames[i]]);
+            EXPECT_THAT(timed.atoms(i).coords().reshaped(), Each(FloatNear(frames[i], 1e-3)));
+        }
+
+        // Lazy frames have the times of the index, without decoding
+        MolSystem lazy("traj.pdb");
+        lazy.add_lazy_trajectory(file_name);
+        MolSystem eager("traj.pdb");
+        eager.add_trajectory(file_name);
+        for (size_t frame = 0; frame < times.size(); ++frame)
+        {
+            EXPECT_EQ(lazy.frame_time(frame), eager.frame_time(frame));
+        }
+        EXPECT_EQ(lazy.reader_stats().frames_decoded, 0);
+
+        // Gromacs' plugins do not tell times, so they are all zero
+        MolfileReader pdb_reader(".pdb");
+        ASSERT_EQ(pdb_reader.open("traj.pdb"), MolReader::SUCCESS);
+        auto data = pdb_reader.read_atoms();
+        pdb_reader.close();
+        MolfileReader reader(std::filesystem::path(file_name).extension());
+        size_t num_frames = 0;
+        auto count = [&num_frames](size_t const, Timestep&)
+        {
+            ++num_frames;
+            return true;
+        };
+        EXPECT_EQ(reader.stream_trajectory_times(file_name, *data, count, 0, 0), MolReader::SUCCESS);
+        EXPECT_EQ(num_frames, times.size());
+        EXPECT_EQ(reader.stream_trajectory_times(file_name, *data, count, 1, 30), MolReader::SUCCESS);
+        EXPECT_EQ(num_frames, times.size());
+        std::filesystem::remove(file_name);
+    }
+}
+
+TEST(System, Snapshot) {
+    MolSystem mol("4lad.pdb");
+    mol.add_trajectory("4lad.pdb");
+    mol.guess_bonds(0);
+    EXPECT_THROW(mol.save("missing/4lad.molpp"), MolError);
+    mol.save("4lad.molpp", true);
+
+    MolSystem loaded("4lad.molpp");
+    EXPECT_THROW(loaded.atoms(0), MolError);
+    loaded.add_trajectory("4lad.molpp");
+    AtomSel atoms{mol.atoms(0)};
+    AtomSel loaded_atoms{loaded.atoms(0)};
+    ASSERT_EQ(loaded_atoms.size(), atoms.size());
+    EXPECT_EQ(loaded_atoms[650].name(), atoms[650].name());
+    EXPECT_EQ(loaded_atoms[650].resid(), atoms[650].resid());
+    EXPECT_THAT(loaded_atoms[650].bond(648), NotNull());
+    EXPECT_THAT(loaded_atoms[1791].bond(1407), NotNull());
+    EXPECT_EQ(loaded_atoms.bonds().size(), atoms.bonds().size());
+    EXPECT_THAT(loaded_atoms.coords().reshaped(), ElementsAreArray(atoms.coords().reshaped()));
+    std::filesystem::remove("4lad.molpp");
+}
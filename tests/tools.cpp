@@ -4,7 +4,9 @@
 #include "tools/Graph.hpp"
 #include "tools/math.hpp"
 #include "tools/SpatialSearch.hpp"
+#include "tools/ThreadPool.hpp"
 #include <molpp/MolppCore.hpp>
+#include <molpp/QuantizedTimestep.hpp>
 #include <molpp/internal/SelIndex.hpp>
 #include <molpp/internal/VectorView.hpp>
 #include <gtest/gtest.h>
@@ -198,6 +200,87 @@ TEST(DataStructures, SpatialSearch) {
         FieldsAre(9, 6, FloatNear(2.5074, 0.0001))));
 }
 
+TEST(DataStructures, PeriodicSpatialSearch) {
+    Eigen::Matrix3Xf points(3, 4);
+    points << 0.5, 9.5, 5.0, 0.5,
+              5.0, 5.0, 5.0, 9.8,
+              5.0, 5.0, 5.0, 5.2;
+
+    // Open boundaries
+    SpatialSearch<Eigen::Matrix3Xf> open_search(points, 2.0, UnitCell());
+    EXPECT_THAT(open_search.pairs(2.0), IsEmpty());
+
+    // Points near opposite faces are neighbors
+    SpatialSearch<Eigen::Matrix3Xf> search(points, 2.0, UnitCell({10, 10, 10}));
+    EXPECT_THAT(search.pairs(2.0), UnorderedElementsAre(FieldsAre(1, 0, FloatNear(1.0, 0.0001))));
+    EXPECT_THAT(search.query(0, 2.0), UnorderedElementsAre(0, 1));
+    EXPECT_THAT(search.query(3, 4.95), UnorderedElementsAre(0, 1, 3));
+    EXPECT_THAT(search.pairs(4.95), UnorderedElementsAre(
+        FieldsAre(1, 0, FloatNear(1.0, 0.0001)),
+        FieldsAre(2, 0, FloatNear(20.25, 0.0001)),
+        FieldsAre(2, 1, FloatNear(20.25, 0.0001)),
+        FieldsAre(3, 0, FloatNear(23.08, 0.0001)),
+        FieldsAre(3, 1, FloatNear(24.08, 0.0001))));
+
+    // Points outside the box are wrapped
+    Eigen::Matrix3Xf shifted = points;
+    shifted.col(0) += Point3(20, -10, 30);
+    SpatialSearch<Eigen::Matrix3Xf> shifted_search(shifted, 2.0, UnitCell({10, 10, 10}));
+    EXPECT_THAT(shifted_search.pairs(2.0), UnorderedElementsAre(FieldsAre(1, 0, FloatNear(1.0, 0.0001))));
+
+    // Skewed box: points are 1.0 apart through the second box vector
+    Box3 box;
+    box << 10, 2, 0,
+           0, 10, 0,
+           0, 0, 10;
+    Eigen::Matrix3Xf skewed_points(3, 2);
+    skewed_points << 0.5, 2.5,
+                     0.5, 9.5,
+                     5.0, 5.0;
+    SpatialSearch<Eigen::Matrix3Xf> skewed_search(skewed_points, 2.0, UnitCell::from_vectors(box));
+    EXPECT_THAT(skewed_search.pairs(2.0), UnorderedElementsAre(FieldsAre(1, 0, FloatNear(1.0, 0.0001))));
+}
+
+TEST(DataStructures, QuantizedSpatialSearch) {
+    Eigen::Matrix3Xf points(3, 4);
+    points << 0.5, 9.5, 5.0, 0.5,
+              5.0, 5.0, 5.0, 9.8,
+              5.0, 5.0, 5.0, 5.2;
+    Timestep ts(4);
+    ts.coords() = points;
+    ts.cell() = UnitCell({10, 10, 10});
+    QuantizedTimestep const quantized(ts);
+    auto const coords = quantized.coords();
+
+    SpatialSearch<decltype(coords)> search(coords, 2.0, quantized.cell());
+    EXPECT_THAT(search.pairs(2.0), UnorderedElementsAre(FieldsAre(1, 0, FloatNear(1.0, 0.001))));
+    EXPECT_THAT(search.query(3, 4.95), UnorderedElementsAre(0, 1, 3));
+
+    SpatialSearch<decltype(coords)> open_search(coords, 3.0);
+    EXPECT_THAT(open_search.query(2, 4.6), UnorderedElementsAre(0, 1, 2));
+}
+
+TEST(Parallel, ThreadPool) {
+    EXPECT_GT(ThreadPool().size(), 0);
+    std::vector<int> values(100, 0);
+    std::vector<std::future<void>> tasks;
+    {
+        ThreadPool pool(4);
+        EXPECT_EQ(pool.size(), 4);
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            tasks.push_back(pool.submit([&values, i]() { values[i] = i; }));
+        }
+        tasks.push_back(pool.submit([]() { throw std::runtime_error("task"); }));
+    }
+
+    std::vector<int> expected(100);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(values, expected);
+    EXPECT_NO_THROW(tasks.front().get());
+    EXPECT_THROW(tasks.back().get(), std::runtime_error);
+}
+
 TEST(Math, Comparison) {
     EXPECT_TRUE(approximately_equal(95.1, 100.0, 0.05));
     EXPECT_FALSE(essentially_equal(95.1, 100.0, 0.05));
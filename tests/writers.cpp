@@ -0,0 +1,179 @@
+#include "writers/MolWriter.hpp"
+#include "writers/XTCWriter.hpp"
+#include "writers/TRRWriter.hpp"
+#include "writers/DCDWriter.hpp"
+#include "writers/PDBWriter.hpp"
+#include "readers/xtc.hpp"
+#include "readers/MolfileReader.hpp"
+#include "core/MolData.hpp"
+#include <molpp/MolSystem.hpp>
+#include <molpp/TrajectoryWriter.hpp>
+#include <molpp/MolError.hpp>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <filesystem>
+#include <random>
+
+using namespace testing;
+using namespace mol;
+using namespace mol::internal;
+
+TEST(Writers, MolWriter) {
+    EXPECT_TRUE(XTCWriter::can_write(".xtc"));
+    EXPECT_TRUE(TRRWriter::can_write(".trr"));
+    EXPECT_TRUE(DCDWriter::can_write(".dcd"));
+    EXPECT_TRUE(PDBWriter::can_write(".pdb"));
+    EXPECT_THAT(MolWriter::from_file_ext(".xtc"), NotNull());
+    EXPECT_THAT(MolWriter::from_file_ext(".trr"), NotNull());
+    EXPECT_THAT(MolWriter::from_file_ext(".dcd"), NotNull());
+    EXPECT_THAT(MolWriter::from_file_ext(".pdb"), NotNull());
+    EXPECT_THAT(MolWriter::from_file_ext(".mol2"), IsNull());
+}
+
+TEST(Writers, XTCCompression) {
+    // Water-like clusters, which use the small runs
+    size_t const num_atoms = 300;
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> position(-40, 40);
+    std::normal_distribution<float> offset(0, 1);
+    std::vector<float> coords(3 * num_atoms);
+    for (size_t i = 0; i < num_atoms; ++i)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            coords[3 * i + k] = (i % 3) ? coords[3 * (i - i % 3) + k] + offset(generator) : position(generator);
+        }
+    }
+
+    xtc::Header header = {int(num_atoms), 5, 0, {1, 0, 0, 0, 2, 0, 0, 0, 3}};
+    std::vector<unsigned char> data;
+    ASSERT_TRUE(xtc::write_frame(header, coords.data(), xtc::DEFAULT_PRECISION, data));
+    EXPECT_EQ(data.size() % 4, 0);
+    EXPECT_LT(data.size(), 3 * sizeof(float) * num_atoms / 2);
+    EXPECT_EQ(xtc::frame_size(data.data(), data.size()), data.size());
+
+    xtc::Header read;
+    ASSERT_TRUE(xtc::read_header(data.data(), data.size(), read));
+    EXPECT_EQ(read.num_atoms, header.num_atoms);
+    EXPECT_EQ(read.step, 5);
+    EXPECT_THAT(read.box, ElementsAreArray(header.box));
+    std::vector<float> decoded(3 * num_atoms);
+    ASSERT_TRUE(xtc::read_coords(data.data(), data.size(), decoded.data()));
+    for (size_t i = 0; i < coords.size(); ++i)
+    {
+        EXPECT_NEAR(decoded[i], coords[i], 0.0051);
+    }
+
+    // Small systems are stored as they are
+    header.num_atoms = 3;
+    data.clear();
+    ASSERT_TRUE(xtc::write_frame(header, coords.data(), xtc::DEFAULT_PRECISION, data));
+    ASSERT_TRUE(xtc::read_coords(data.data(), data.size(), decoded.data()));
+    for (size_t i = 0; i < 9; ++i)
+    {
+        EXPECT_FLOAT_EQ(decoded[i], coords[i]);
+    }
+
+    // Too large for the precision
+    coords[0] = 1e10;
+    header.num_atoms = num_atoms;
+    EXPECT_FALSE(xtc::write_frame(header, coords.data(), xtc::DEFAULT_PRECISION, data));
+}
+
+TEST(Writers, TrajectoryWriter) {
+    MolSystem mol("dipeptide.psf");
+    mol.add_trajectory("dipeptide.xtc");
+    std::vector<index_t> const indices = {0, 2, 3, 4, 5, 8, 9, 10, 11, 12, 17, 20};
+    AtomSel atoms = mol.select(indices);
+    EXPECT_THROW(TrajectoryWriter("subset.mol2", atoms), MolError);
+
+    for (std::string const ext : {".pdb", ".xtc", ".trr", ".dcd"})
+    {
+        TrajectoryWriter writer("subset" + ext, atoms, 1);
+        writer.write(0);
+        mol.stream_trajectory("dipeptide.xtc", [&writer](size_t const, Timestep &ts)
+        {
+            writer.write(ts);
+            return true;
+        }, 1);
+        EXPECT_THROW(writer.write(Timestep(2)), MolError);
+        writer.close();
+        EXPECT_THROW(writer.write(1), MolError);
+    }
+
+    // Each file holds both frames of the subset
+    MolSystem subset("subset.pdb");
+    ASSERT_EQ(subset.atoms().size(), indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        Atom const atom = subset.atoms()[i];
+        Atom const expected = atoms[i];
+        EXPECT_EQ(atom.name(), expected.name());
+        EXPECT_EQ(atom.resname(), expected.resname());
+        EXPECT_EQ(atom.resid(), expected.resid());
+    }
+
+    subset.add_trajectory("subset.pdb");
+    subset.add_trajectory("subset.xtc");
+    subset.add_trajectory("subset.trr");
+    subset.add_trajectory("subset.dcd");
+    float const tolerance[] = {0.0006, 0.0051, 0.0001, 0};
+    for (size_t file = 0; file < 4; ++file)
+    {
+        for (size_t frame = 0; frame < 2; ++frame)
+        {
+            AtomSel expected = mol.select(indices, frame);
+            AtomSel actual = subset.atoms(2 * file + frame);
+            EXPECT_LE((actual.coords() - expected.coords()).cwiseAbs().maxCoeff(), tolerance[file]);
+            EXPECT_TRUE(actual.timestep().cell().lengths().isApprox(expected.timestep().cell().lengths(), 1e-3));
+        }
+    }
+
+    // Also readable by the molfile plugins
+    auto data = MolfileReader(".pdb").read_topology("subset.pdb");
+    ASSERT_THAT(data, NotNull());
+    EXPECT_EQ(MolfileReader(".xtc").read_trajectory("subset.xtc", *data), MolReader::SUCCESS);
+    EXPECT_EQ(MolfileReader(".trr").read_trajectory("subset.trr", *data), MolReader::SUCCESS);
+    EXPECT_EQ(MolfileReader(".dcd").read_trajectory("subset.dcd", *data), MolReader::SUCCESS);
+    ASSERT_EQ(data->trajectory().num_frames(), 6);
+    for (size_t frame = 0; frame < 6; ++frame)
+    {
+        AtomSel expected = mol.select(indices, frame % 2);
+        Coord3 const actual = data->trajectory().timestep(frame).coords();
+        EXPECT_LE((actual - expected.coords()).cwiseAbs().maxCoeff(), 0.0051);
+    }
+
+    for (std::string const ext : {".pdb", ".xtc", ".trr", ".dcd"})
+    {
+        std::filesystem::remove("subset" + ext);
+    }
+}
+
+TEST(Writers, SubsetTrajectoryWriter) {
+    MolSystem reference("dipeptide.psf");
+    reference.add_trajectory("dipeptide.xtc");
+    MolSystem mol("dipeptide.psf");
+    mol.add_trajectory("dipeptide.xtc", mol.select(std::vector<index_t> {2, 3, 5}));
+    std::vector<index_t> const indices = {3, 5};
+
+    // Timesteps of the trajectory only hold its atoms
+    {
+        TrajectoryWriter writer("compact.pdb", mol.select(indices), 1);
+        writer.write(mol.atoms(0).timestep());
+        writer.write(reference.atoms(1).timestep());
+        EXPECT_THROW(writer.write(Timestep(2)), MolError);
+        TrajectoryWriter missing("missing.pdb", mol.select(std::vector<index_t> {0, 3}), 1);
+        EXPECT_THROW(missing.write(mol.atoms(0).timestep()), MolError);
+    }
+
+    MolSystem compact("compact.pdb");
+    compact.add_trajectory("compact.pdb");
+    EXPECT_THROW(compact.atoms(2), MolError);
+    for (size_t frame = 0; frame < 2; ++frame)
+    {
+        AtomSel expected = reference.select(indices, frame);
+        EXPECT_LE((compact.atoms(frame).coords() - expected.coords()).cwiseAbs().maxCoeff(), 0.0006);
+    }
+    std::filesystem::remove("compact.pdb");
+    std::filesystem::remove("missing.pdb");
+}